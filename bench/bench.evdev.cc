@@ -0,0 +1,138 @@
+// microbenchmark: syscalls per event of manymouse's evdev poller, as before (one read() per
+// event, round-robin over every mouse) vs batched reads driven by epoll readiness.
+// nonblocking pipes stand in for the /dev/input/event* fds.
+
+// system headers first, so the include guards keep them out of the namespaces below
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <linux/input.h>
+
+#include <iostream>
+
+#include "../hyde.hpp"
+
+static size_t syscalls = 0;
+
+ssize_t counted_read( int fd, void *buf, size_t count )
+{
+    ++syscalls;
+    return read( fd, buf, count );
+}
+
+int counted_epoll_wait( int epfd, epoll_event *events, int maxevents, int timeout )
+{
+    ++syscalls;
+    return epoll_wait( epfd, events, maxevents, timeout );
+}
+
+#define read counted_read
+#define epoll_wait counted_epoll_wait
+
+#include "../deps/manymouse/manymouse.h"
+
+namespace before
+{
+    // batch of 1, and init_epoll() is never called: plain round-robin
+#   define MANYMOUSE_EVDEV_BATCH 1
+#   include "../deps/manymouse/linux_evdev.c"
+#   undef MANYMOUSE_EVDEV_BATCH
+}
+
+namespace after
+{
+#   include "../deps/manymouse/linux_evdev.c"
+}
+
+#undef read
+#undef epoll_wait
+
+template< typename MOUSE, typename POLL >
+double bench( const char *title, MOUSE *mice, unsigned &available, POLL poll, void (*init)(), size_t devices, size_t frames )
+{
+    // a 1000 Hz mouse read at 60 Hz: ~16 REL_X + REL_Y + SYN_REPORT reports per frame.
+    // the other devices stay idle.
+    const size_t reports = 16;
+
+    std::vector< int > writers( devices );
+
+    for( size_t d = 0; d < devices; ++d )
+    {
+        int fds[2];
+        pipe( fds );
+        fcntl( fds[0], F_SETFL, O_NONBLOCK );
+
+        mice[d].fd = fds[0];
+        mice[d].event_pos = mice[d].event_count = 0;
+        writers[d] = fds[1];
+    }
+
+    available = unsigned( devices );
+
+    if( init )
+        init();
+
+    size_t events = 0;
+    syscalls = 0;
+
+    hyde::hid::dt timer;
+
+    for( size_t f = 0; f < frames; ++f )
+    {
+        input_event feed[ reports * 3 ] = {};
+
+        for( size_t r = 0; r < reports; ++r )
+        {
+            feed[ r * 3 + 0 ].type = EV_REL, feed[ r * 3 + 0 ].code = REL_X, feed[ r * 3 + 0 ].value = 1;
+            feed[ r * 3 + 1 ].type = EV_REL, feed[ r * 3 + 1 ].code = REL_Y, feed[ r * 3 + 1 ].value = -1;
+            feed[ r * 3 + 2 ].type = EV_SYN, feed[ r * 3 + 2 ].code = SYN_REPORT;
+        }
+
+        write( writers[0], feed, sizeof( feed ) );
+
+        ManyMouseEvent event;
+        while( poll( &event ) )
+            ++events;
+    }
+
+    double ns = timer.ns() / events;
+
+    std::cout << title << ", " << devices << " device(s): " << double( syscalls ) / events << " syscalls/event, "
+        << ns << " ns/event (" << events << " events)" << std::endl;
+
+    for( size_t d = 0; d < devices; ++d )
+    {
+        close( mice[d].fd );
+        close( writers[d] );
+    }
+
+    available = 0;
+
+    return double( syscalls ) / events;
+}
+
+int main()
+{
+    const size_t frames = 100000;
+
+    for( size_t devices = 1; devices <= 32; devices *= 32 )
+    {
+        double b = bench( "before: one event per read()", before::mice, before::available_mice, before::linux_evdev_poll, 0, devices, frames );
+        double a = bench( "after:  batched read(), epoll", after::mice, after::available_mice, after::linux_evdev_poll, after::init_epoll, devices, frames );
+
+        std::cout << "syscalls: x" << ( b / a ) << " fewer" << std::endl;
+
+        if( after::epoll_fd != -1 )
+            close( after::epoll_fd ), after::epoll_fd = -1;
+    }
+
+    return 0;
+}
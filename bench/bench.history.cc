@@ -0,0 +1,95 @@
+// microbenchmark: per-set() cost of hyde::history ring buffer vs legacy std::deque storage
+
+#include <deque>
+#include <iostream>
+
+#include "../hyde.hpp"
+
+namespace legacy
+{
+    // former hyde::history storage policy: push_front + pop_back on a std::deque
+    template< typename SAMPLE_TYPE, const int N = 120 >
+    class history
+    {
+        std::deque< SAMPLE_TYPE > container;
+
+        public:
+
+        history() : container( N )
+        {}
+
+        void set( const float &x )
+        {
+            SAMPLE_TYPE new_sample( x );
+
+            if( new_sample == container.front() )
+            {
+                container.front().t = hyde::global_timer.now();
+            }
+            else
+            {
+                container.front().t = hyde::global_timer.now();
+
+                container.push_front( container.front() );
+                container.front().set( new_sample );
+                container.front().t = hyde::global_timer.now();
+
+                if( container.size() > N )
+                    container.pop_back();
+            }
+        }
+
+        const SAMPLE_TYPE &newest() const
+        {
+            return container.front();
+        }
+    };
+}
+
+template<typename HISTORY>
+double bench( const char *title, size_t iterations, size_t samples_per_frame = 1 )
+{
+    HISTORY h;
+    float sink = 0;
+
+    hyde::hid::dt timer;
+
+    for( size_t i = 0; i < iterations; i += samples_per_frame )
+    {
+        // frame-clock mode when samples_per_frame > 1: one clock read per poll cycle
+        if( samples_per_frame > 1 )
+            hyde::global_timer.freeze();
+
+        for( size_t j = 0; j < samples_per_frame; ++j )
+        {
+            h.set( float( ( i + j ) & 1 ) );
+            sink += h.newest().x;
+        }
+
+        if( samples_per_frame > 1 )
+            hyde::global_timer.unfreeze();
+    }
+
+    double ns = timer.ns() / iterations;
+
+    std::cout << title << ": " << ns << " ns/set() (" << iterations << " samples, checksum " << sink << ")" << std::endl;
+
+    return ns;
+}
+
+int main()
+{
+    const size_t iterations = 10 * 1000 * 1000;
+
+    double ring  = bench< hyde::history< hyde::types::hid::vec1<float>, 120 > >( "hyde::history<vec1,120> (ring) ", iterations );
+    double deque = bench< legacy::history< hyde::types::hid::vec1<float>, 120 > >( "legacy::history<vec1,120> (deque)", iterations );
+
+    std::cout << "speedup: x" << ( deque / ring ) << std::endl;
+
+    // a 256-key keyboard writing all its keys within a single poll cycle
+    double frame = bench< hyde::history< hyde::types::hid::vec1<float>, 120 > >( "hyde::history<vec1,120> (ring, frame-clock)", iterations, 256 );
+
+    std::cout << "speedup: x" << ( ring / frame ) << " (frame-clock vs per-set() clock reads)" << std::endl;
+
+    return 0;
+}
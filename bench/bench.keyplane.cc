@@ -0,0 +1,113 @@
+// microbenchmark: per-key predicates vs hyde::keyplane bulk queries over a 256-key keymap.
+// also checks both agree on every key after every poll, taps within a poll included (build
+// with -DHYDE_NO_SIMD, -msse2 and -mavx2 to check every code path of the interval queries).
+
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "../hyde.hpp"
+
+int main()
+{
+    const size_t polls = 200;
+    const size_t iterations = 10000;
+
+#if defined(HYDE_SIMD_AVX2)
+    std::cout << "keyplane: avx2" << std::endl;
+#elif defined(HYDE_SIMD_SSE2)
+    std::cout << "keyplane: sse2" << std::endl;
+#else
+    std::cout << "keyplane: scalar" << std::endl;
+#endif
+
+    hyde::buttons keymap( hyde::keybits::capacity );
+    hyde::keyplane keystate;
+
+    {
+        hyde::hid::frame init( hyde::global_timer );
+
+        keystate.reset( hyde::global_timer.now() );
+
+        for( auto &it : keymap )
+        {
+            it.clear();
+            it.age_from( &keystate.polls() );
+        }
+    }
+
+    // random presses and releases, polled at random 0..25 ms intervals. some keys also get
+    // events in between polls, as event-driven keyboards do (see keyplane::set())
+    std::mt19937 rng( 1 );
+    hyde::keybits now;
+    size_t mismatches = 0, checks = 0;
+
+    const float interval = 0.005f;
+
+    for( size_t p = 0; p < polls; ++p )
+    {
+        for( size_t k = 0; k < hyde::keybits::capacity; ++k )
+            if( rng() % 8 == 0 )
+                now.set( k, !now.test( k ) );
+
+        std::this_thread::sleep_for( std::chrono::microseconds( rng() % 12500 ) );
+
+        for( size_t e = rng() % 4; e--; )
+        {
+            hyde::keybits event = keystate.state();
+            size_t k = rng() % hyde::keybits::capacity;
+            event.set( k, !event.test( k ) );
+
+            hyde::hid::tick t = hyde::global_timer.now();
+
+            keystate.set( event, t ).for_each( [&]( size_t key ) {
+                keymap[ key ].set_at( t, event.test( key ) ? 0.5f : 0.f );
+            } );
+        }
+
+        std::this_thread::sleep_for( std::chrono::microseconds( rng() % 12500 ) );
+
+        {
+            hyde::hid::frame poll( hyde::global_timer );
+
+            keystate.update( now, hyde::global_timer.now() ).for_each( [&]( size_t k ) {
+                keymap[ k ].set( now.test( k ) ? 0.5f : 0.f );
+            } );
+        }
+
+        hyde::keybits hold = keystate.hold(), trigger = keystate.trigger(), release = keystate.release(), idle = keystate.idle();
+        hyde::keybits recent_trigger = keystate.trigger( hyde::keybits::all(), interval );
+        hyde::keybits recent_release = keystate.release( hyde::keybits::all(), interval );
+
+        for( size_t k = 0; k < hyde::keybits::capacity; ++k, checks += 6 )
+        {
+            mismatches += hold.test( k ) != keymap[ k ].hold();
+            mismatches += trigger.test( k ) != keymap[ k ].trigger();
+            mismatches += release.test( k ) != keymap[ k ].release();
+            mismatches += idle.test( k ) != keymap[ k ].idle();
+            mismatches += recent_trigger.test( k ) != keymap[ k ].trigger( interval );
+            mismatches += recent_release.test( k ) != keymap[ k ].release( interval );
+        }
+    }
+
+    std::cout << "equivalence: " << mismatches << " mismatches out of " << checks << " checks" << std::endl;
+
+    size_t sink = 0;
+
+    hyde::hid::dt timer;
+    for( size_t i = 0; i < iterations; ++i )
+        for( auto &it : keymap )
+            sink += it.hold() + it.trigger() + it.release() + it.idle();
+    double per_key_ns = timer.ns() / iterations;
+
+    timer.reset();
+    for( size_t i = 0; i < iterations; ++i )
+        sink += keystate.hold().count() + keystate.trigger().count() + keystate.release().count() + keystate.idle().count();
+    double bulk_ns = timer.ns() / iterations;
+
+    std::cout << "per-key predicates: " << per_key_ns << " ns/keymap" << std::endl;
+    std::cout << "keyplane bulk:      " << bulk_ns << " ns/keymap (checksum " << sink << ")" << std::endl;
+    std::cout << "speedup: x" << ( per_key_ns / bulk_ns ) << std::endl;
+
+    return mismatches ? 1 : 0;
+}
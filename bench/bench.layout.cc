@@ -0,0 +1,61 @@
+// microbenchmark: array-of-structs (hyde::history) vs struct-of-arrays (hyde::history_soa) sample layouts
+
+#include <iostream>
+#include <thread>
+
+#include "../hyde.hpp"
+
+template<typename HISTORY>
+void bench( const char *title, size_t iterations )
+{
+    // a few hundred histories, so scans do not fit in L1 like a single history would
+    const size_t controls = 256;
+    std::vector< HISTORY > histories( controls );
+
+    for( size_t i = 0; i < 120; ++i )
+    {
+        for( auto &h : histories )
+            h.set( float( i & 1 ) );
+
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+    }
+
+    double sink = 0;
+
+    hyde::hid::dt timer;
+    for( size_t i = 0; i < iterations; ++i )
+        for( auto &h : histories )
+            sink += h.duration();
+    double duration_ns = timer.ns() / ( iterations * controls );
+
+    timer.reset();
+    for( size_t i = 0; i < iterations; ++i )
+        for( auto &h : histories )
+            sink += h.then_t( h.duration() * 0.5 ).x;
+    double find_t_ns = timer.ns() / ( iterations * controls );
+
+    timer.reset();
+    for( size_t i = 0; i < iterations; ++i )
+        for( auto &h : histories )
+            sink += h.trigger() + h.release() + h.idle() + h.hold() + h.click() + h.dclick();
+    double predicates_ns = timer.ns() / ( iterations * controls );
+
+    std::cout << title << ": "
+        << sizeof( HISTORY ) << " bytes/history, "
+        << duration_ns << " ns/duration(), "
+        << find_t_ns << " ns/then_t(), "
+        << predicates_ns << " ns/predicates (checksum " << sink << ")" << std::endl;
+}
+
+int main()
+{
+    const size_t iterations = 10000;
+
+    bench< hyde::history< hyde::types::hid::vec1<float>, 120 > >( "hyde::history<vec1,120>     (aos)", iterations );
+    bench< hyde::history_soa< hyde::types::hid::vec1<float>, 120 > >( "hyde::history_soa<vec1,120> (soa)", iterations );
+
+    bench< hyde::history< hyde::types::hid::vec2<float>, 120 > >( "hyde::history<vec2,120>     (aos)", iterations );
+    bench< hyde::history_soa< hyde::types::hid::vec2<float>, 120 > >( "hyde::history_soa<vec2,120> (soa)", iterations );
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+// reproducible microbenchmarks of hyde's hot paths, machine readable for tracking regressions.
+// usage: bench.suite [--json|--csv]
+//
+// every benchmark runs under a hid::virtual_clock with fixed seeds, so each run does the same
+// work; each one is repeated 5 times and the median ns/op is reported.
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../hyde.hpp"
+
+struct result
+{
+    std::string name;
+    double ns_per_op;
+    size_t ops;
+};
+
+std::vector< result > results;
+
+// fn( ops ) does 'ops' operations; returns median ns/op of 5 runs (after a warm-up run)
+template< typename FN >
+void measure( const std::string &name, size_t ops, FN fn )
+{
+    std::vector< double > runs;
+
+    fn( ops );
+
+    for( int r = 0; r < 5; ++r )
+    {
+        hyde::hid::dt timer;
+        fn( ops );
+        runs.push_back( timer.ns() / ops );
+    }
+
+    std::sort( runs.begin(), runs.end() );
+
+    result res = { name, runs[ runs.size() / 2 ], ops };
+    results.push_back( res );
+}
+
+size_t sink = 0;
+
+void bench_history( hyde::hid::virtual_clock &clock )
+{
+    hyde::button button;
+
+    measure( "history.set.changed", 1000000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops; ++i )
+        {
+            clock.advance_ticks( 1000000 );
+            button.set( i & 1 ? 0.5f : 0.f );
+        }
+    } );
+
+    measure( "history.set.unchanged", 1000000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops; ++i )
+        {
+            clock.advance_ticks( 1000000 );
+            button.set( 0.5f );
+        }
+    } );
+
+    hyde::timed_button timed;
+
+    measure( "history_timed.set.changed", 1000000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops; ++i )
+        {
+            clock.advance_ticks( 1000000 );
+            timed.set( i & 1 ? 0.5f : 0.f );
+        }
+    } );
+
+    // 120 samples, 1 ms apart
+    hyde::coordinate coord;
+
+    for( int i = 0; i < 120; ++i )
+    {
+        clock.advance_ticks( 1000000 );
+        coord.set( float( i ), 0.f );
+    }
+
+    // all within duration() (118 ms), so find_t() searches instead of clamping to the oldest sample
+    const int depths[] = { 1, 10, 60, 110 };
+
+    for( int depth : depths )
+        measure( "history.find_t.depth" + std::to_string( depth ), 1000000, [&]( size_t ops ) {
+            for( size_t i = 0; i < ops; ++i )
+                sink += size_t( coord.then_t( depth * 0.001 ).x );
+        } );
+}
+
+void bench_gestures( hyde::hid::virtual_clock &clock )
+{
+    // 64 buttons tapped at random (5 to 300 ms between polls, each button up to 5 ms late), so
+    // predicates answer differently from one button to the next and nothing can be hoisted
+    std::vector< hyde::button > buttons( 64 );
+    std::mt19937 rng( 1 );
+
+    for( int i = 0; i < 120; ++i )
+    {
+        for( auto &button : buttons )
+            button.set_at( clock.now() + hyde::hid::tick( rng() % 5000000 ), rng() & 1 ? 0.5f : 0.f );
+
+        clock.advance( 0.005 + ( rng() % 296 ) * 0.001 );
+    }
+
+    measure( "gesture.trigger", 1000000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops; ++i )
+            sink += buttons[ i & 63 ].trigger() << ( i & 7 );
+    } );
+
+    measure( "gesture.click", 1000000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops; ++i )
+            sink += buttons[ i & 63 ].click() << ( i & 7 );
+    } );
+
+    measure( "gesture.dclick", 1000000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops; ++i )
+            sink += buttons[ i & 63 ].dclick( 0.25f + ( i & 15 ) * 0.05f ) << ( i & 7 );
+    } );
+}
+
+void bench_keyboard( hyde::hid::virtual_clock &clock )
+{
+    // 60 Hz polls of a keyboard typing 100 keys/s, and of one mashing 100k keys/s
+    const double rates[] = { 100, 100000 };
+
+    for( double rate : rates )
+    {
+        hyde::synthetic::keyboard keyboard;
+        keyboard.add_generator( hyde::synthetic::random_generator( hyde::synthetic::KEY, rate, 256, 0, 1 ) );
+
+        measure( "keyboard.update.synthetic" + std::to_string( int( rate ) ) + "hz", 10000, [&]( size_t ops ) {
+            for( size_t i = 0; i < ops; ++i )
+            {
+                clock.advance( 1 / 60.0 );
+                keyboard.update();
+            }
+        } );
+    }
+}
+
+#ifdef __linux__
+
+void bench_evdev( hyde::hid::virtual_clock &clock )
+{
+    // 64 key events per poll through a pipe, as read() + parse + keymap update
+    int fds[2];
+
+    if( pipe( fds ) != 0 )
+        return;
+
+    fcntl( fds[1], F_SETFL, O_NONBLOCK );
+
+    hyde::linux_evdev::keyboard keyboard( "/dev/fd/" + std::to_string( fds[0] ) );
+
+    std::vector< input_event > feed( 64 );
+
+    for( size_t i = 0; i < feed.size(); ++i )
+    {
+        std::memset( &feed[i], 0, sizeof( input_event ) );
+        feed[i].type = i % 2 ? EV_SYN : EV_KEY;
+        feed[i].code = i % 2 ? SYN_REPORT : KEY_A + ( i / 2 ) % 26;
+        feed[i].value = ( i / 2 ) % 2;
+    }
+
+    measure( "evdev.keyboard.event", 64 * 1000, [&]( size_t ops ) {
+        for( size_t i = 0; i < ops / feed.size(); ++i )
+        {
+            sink += write( fds[1], feed.data(), feed.size() * sizeof( input_event ) );
+            clock.advance( 0.001 );
+            keyboard.update();
+        }
+    } );
+
+    close( fds[1] );
+}
+
+#endif
+
+int main( int argc, char **argv )
+{
+    std::string format = argc > 1 ? argv[1] : "";
+
+    hyde::hid::virtual_clock clock( 1 );
+    hyde::hid::clock_scope scope( &clock );
+
+    bench_history( clock );
+    bench_gestures( clock );
+    bench_keyboard( clock );
+#ifdef __linux__
+    bench_evdev( clock );
+#endif
+
+    if( format == "--json" )
+    {
+        std::cout << "{\n  \"benchmarks\": [\n";
+
+        for( size_t i = 0; i < results.size(); ++i )
+            std::cout << "    { \"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].ns_per_op
+                << ", \"ops\": " << results[i].ops << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+
+        std::cout << "  ]\n}" << std::endl;
+    }
+    else if( format == "--csv" )
+    {
+        std::cout << "name,ns_per_op,ops" << std::endl;
+
+        for( auto &it : results )
+            std::cout << it.name << ',' << it.ns_per_op << ',' << it.ops << std::endl;
+    }
+    else
+    {
+        for( auto &it : results )
+            std::cout << it.name << std::string( 36 - std::min< size_t >( 35, it.name.size() ), ' ' ) << it.ns_per_op << " ns/op" << std::endl;
+    }
+
+    return sink == 42 ? 1 : 0;
+}
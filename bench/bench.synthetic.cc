@@ -0,0 +1,55 @@
+// end-to-end cost per event of hyde's own pipeline, no hardware: synthetic keyboard, mouse and
+// gamepad fed by random generators, polled at 60 Hz under a virtual clock (so runs are
+// deterministic and as fast as the cpu allows), with gesture queries after every poll.
+// usage: bench.synthetic [events-per-second-per-device]
+
+#include <cstdlib>
+#include <iostream>
+
+#include "../hyde.hpp"
+
+int main( int argc, char **argv )
+{
+    const double rate = argc > 1 ? std::atof( argv[1] ) : 1e6;
+    const size_t frames = 600;  // 10 seconds of virtual time
+
+    hyde::hid::virtual_clock clock( 1 );
+    hyde::hid::clock_scope scope( &clock );
+
+    hyde::synthetic::keyboard keyboard;
+    hyde::synthetic::mouse mouse;
+    hyde::synthetic::gamepad pad;
+
+    // keys and buttons flip at 1% of the rate, motion and axes take the rest
+    keyboard.add_generator( hyde::synthetic::random_generator( hyde::synthetic::KEY, rate, 256, 0, 1 ) );
+    mouse.add_generator( hyde::synthetic::random_generator( hyde::synthetic::MOTION, rate * 0.99, 2, -8, 8, 2 ) );
+    mouse.add_generator( hyde::synthetic::random_generator( hyde::synthetic::BUTTON, rate * 0.01, 3, 0, 1, 3 ) );
+    pad.add_generator( hyde::synthetic::random_generator( hyde::synthetic::AXIS, rate * 0.99, 8, -1000, 1000, 4 ) );
+    pad.add_generator( hyde::synthetic::random_generator( hyde::synthetic::BUTTON, rate * 0.01, 10, 0, 1, 5 ) );
+
+    size_t gestures = 0;
+
+    hyde::hid::dt timer;
+
+    for( size_t f = 0; f < frames; ++f )
+    {
+        clock.advance( 1 / 60.0 );
+
+        keyboard.update();
+        mouse.update();
+        pad.update();
+
+        gestures += keyboard.keystate.trigger().count() + keyboard.keystate.release().count();
+        gestures += mouse.left.click() + mouse.right.dclick() + pad.a.click() + pad.b.longpress();
+    }
+
+    double ns = timer.ns();
+    size_t events = keyboard.events() + mouse.events() + pad.events();
+
+    std::cout << "synthetic: " << events << " events in " << ( ns / 1e6 ) << " ms, "
+        << ( ns / events ) << " ns/event, " << ( events / ( ns / 1e9 ) / 1e6 ) << " M events/s" << std::endl;
+    std::cout << "mouse motion: " << mouse.coalescing.events() << " events -> " << mouse.coalescing.samples() << " samples" << std::endl;
+    std::cout << "gestures seen: " << gestures << std::endl;
+
+    return 0;
+}
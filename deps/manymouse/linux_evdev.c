@@ -20,6 +20,8 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <time.h>
+#include <sys/epoll.h>
 
 #include <linux/input.h>  /* evdev interface...  */
 
@@ -27,6 +29,12 @@
 
 /* linux allows 32 evdev nodes currently. */
 #define MAX_MICE 32
+
+/* events read per read() syscall. define as 1 to get one syscall per event. */
+#ifndef MANYMOUSE_EVDEV_BATCH
+#define MANYMOUSE_EVDEV_BATCH 64
+#endif
+
 typedef struct
 {
     int fd;
@@ -35,11 +43,25 @@ typedef struct
     int max_x;
     int max_y;
     char name[64];
+    struct input_event events[MANYMOUSE_EVDEV_BATCH];  /* read, not yet served. */
+    int event_pos;
+    int event_count;
+    int drained;  /* last read() came up short, and epoll will tell us when there's more. */
+    int monotonic;  /* kernel stamps events with CLOCK_MONOTONIC. */
 } MouseStruct;
 
 static MouseStruct mice[MAX_MICE];
 static unsigned int available_mice = 0;
 
+/*
+ * epoll readiness layer: only mice flagged in (ready) get read(). A mouse is
+ *  flagged when epoll reports its fd readable, and unflagged once it runs dry.
+ *  If epoll is not available, (epoll_fd) is -1 and every mouse is read on
+ *  each pass, like a plain round-robin.
+ */
+static int epoll_fd = -1;
+static unsigned char ready[MAX_MICE];
+
 
 static int poll_mouse(MouseStruct *mouse, ManyMouseEvent *outevent)
 {
@@ -47,24 +69,54 @@ static int poll_mouse(MouseStruct *mouse, ManyMouseEvent *outevent)
     while (unhandled)  /* read until failure or valid event. */
     {
         struct input_event event;
-        int br = read(mouse->fd, &event, sizeof (event));
-        if (br == -1)
+
+        if (mouse->event_pos == mouse->event_count)
         {
-            if (errno == EAGAIN)
-                return 0;  /* just no new data at the moment. */
+            /* buffer served: refill it with as many events as are pending. */
+            int br;
 
-            /* mouse was unplugged? */
-            close(mouse->fd);  /* stop reading from this mouse. */
-            mouse->fd = -1;
-            outevent->type = MANYMOUSE_EVENT_DISCONNECT;
-            return 1;
+            if (mouse->drained)
+                return 0;  /* skip the read() that would just fail with EAGAIN. */
+
+            br = read(mouse->fd, mouse->events, sizeof (mouse->events));
+            if (br == -1)
+            {
+                if (errno == EAGAIN)
+                    return 0;  /* just no new data at the moment. */
+
+                /* mouse was unplugged? */
+                close(mouse->fd);  /* stop reading from this mouse. */
+                mouse->fd = -1;
+                outevent->type = MANYMOUSE_EVENT_DISCONNECT;
+                return 1;
+            } /* if */
+
+            if (br < (int) sizeof (event))
+                return 0;  /* oh well. */
+
+            /* evdev only hands out whole events. */
+            mouse->event_pos = 0;
+            mouse->event_count = br / sizeof (event);
+            mouse->drained = ((epoll_fd != -1) && (br < (int) sizeof (mouse->events)));
         } /* if */
 
-        if (br != sizeof (event))
-            return 0;  /* oh well. */
+        event = mouse->events[mouse->event_pos++];
 
         unhandled = 0;  /* will reset if necessary. */
         outevent->value = event.value;
+
+        /* CLOCK_REALTIME stamps would jump with the wall clock: don't forward those. */
+        outevent->timestamp = 0;
+        if (mouse->monotonic)
+        {
+            #ifdef input_event_sec
+            outevent->timestamp = ((unsigned long long) event.input_event_sec) * 1000000000ull +
+                                  ((unsigned long long) event.input_event_usec) * 1000ull;
+            #else
+            outevent->timestamp = ((unsigned long long) event.time.tv_sec) * 1000000000ull +
+                                  ((unsigned long long) event.time.tv_usec) * 1000ull;
+            #endif
+        } /* if */
         if (event.type == EV_REL)
         {
             outevent->type = MANYMOUSE_EVENT_RELMOTION;
@@ -209,7 +261,19 @@ static int init_mouse(const char *fname, int fd)
     if (ioctl(fd, EVIOCGNAME(sizeof (mouse->name)), mouse->name) == -1)
         snprintf(mouse->name, sizeof (mouse->name), "Unknown device");
 
+    /* have the kernel stamp events with the clock games measure time with. */
+    mouse->monotonic = 0;
+    #ifdef EVIOCSCLOCKID
+    {
+        int clock_id = CLOCK_MONOTONIC;
+        if (ioctl(fd, EVIOCSCLOCKID, &clock_id) != -1)
+            mouse->monotonic = 1;
+    }
+    #endif
+
     mouse->fd = fd;
+    mouse->event_pos = mouse->event_count = 0;
+    mouse->drained = 0;
 
     return 1;  /* we're golden. */
 } /* init_mouse */
@@ -245,6 +309,50 @@ static int open_if_mouse(const char *fname)
 } /* open_if_mouse */
 
 
+static void init_epoll(void)
+{
+    unsigned int i;
+
+    memset(ready, '\0', sizeof (ready));
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+        return;  /* fall back to reading every mouse. */
+
+    for (i = 0; i < available_mice; i++)
+    {
+        struct epoll_event ev;
+        memset(&ev, '\0', sizeof (ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, mice[i].fd, &ev) == -1)
+        {
+            close(epoll_fd);
+            epoll_fd = -1;
+            return;
+        } /* if */
+    } /* for */
+} /* init_epoll */
+
+
+/* flag readable mice, waiting up to (timeout_ms). Returns count, or -1. Needs epoll. */
+static int update_ready(int timeout_ms)
+{
+    struct epoll_event events[MAX_MICE];
+    unsigned int i;
+    int n;
+
+    n = epoll_wait(epoll_fd, events, MAX_MICE, timeout_ms);
+    for (i = 0; (int) i < n; i++)
+    {
+        ready[events[i].data.u32] = 1;
+        mice[events[i].data.u32].drained = 0;
+    } /* for */
+
+    return n;
+} /* update_ready */
+
+
 static int linux_evdev_init(void)
 {
     DIR *dirp;
@@ -268,6 +376,8 @@ static int linux_evdev_init(void)
 
     closedir(dirp);
 
+    init_epoll();
+
     return available_mice;
 } /* linux_evdev_init */
 
@@ -280,6 +390,12 @@ static void linux_evdev_quit(void)
         if (fd != -1)
             close(fd);
     } /* while */
+
+    if (epoll_fd != -1)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+    } /* if */
 } /* linux_evdev_quit */
 
 
@@ -296,16 +412,24 @@ static int linux_evdev_poll(ManyMouseEvent *event)
      *  prevents a chatty mouse from dominating the queue.
      */
     static unsigned int i = 0;
+    int pass;
 
     if (i >= available_mice)
         i = 0;  /* handle reset condition. */
 
-    if (event != NULL)
+    if (event == NULL)
+        return 0;
+
+    /* serve mice already flagged first, then ask epoll once for more. */
+    for (pass = 0; pass < 2; pass++)
     {
+        if ((pass == 1) && ((epoll_fd == -1) || (update_ready(0) <= 0)))
+            break;
+
         while (i < available_mice)
         {
             MouseStruct *mouse = &mice[i];
-            if (mouse->fd != -1)
+            if ((ready[i] || (epoll_fd == -1)) && (mouse->fd != -1))
             {
                 if (poll_mouse(mouse, event))
                 {
@@ -313,20 +437,47 @@ static int linux_evdev_poll(ManyMouseEvent *event)
                     return 1;
                 } /* if */
             } /* if */
+            ready[i] = 0;  /* ran dry (or gone): wait for epoll to flag it. */
             i++;
         } /* while */
-    } /* if */
+
+        i = 0;
+    } /* for */
 
     return 0;  /* no new events */
 } /* linux_evdev_poll */
 
+
+static int linux_evdev_wait(int timeout_ms)
+{
+    unsigned int i;
+    int n;
+
+    /* events already read, but not served yet. */
+    for (i = 0; i < available_mice; i++)
+    {
+        if ((mice[i].fd != -1) && (mice[i].event_pos < mice[i].event_count))
+            return 1;
+    } /* for */
+
+    if (epoll_fd == -1)
+        return -1;  /* can't sleep on the fds, caller has to poll. */
+
+    n = update_ready(timeout_ms);
+    if ((n == -1) && (errno == EINTR))
+        return 0;
+
+    return (n > 0) ? 1 : n;
+} /* linux_evdev_wait */
+
 static const ManyMouseDriver ManyMouseDriver_interface =
 {
     "Linux /dev/input/event* interface",
     linux_evdev_init,
     linux_evdev_quit,
     linux_evdev_name,
-    linux_evdev_poll
+    linux_evdev_poll,
+    linux_evdev_wait
 };
 
 const ManyMouseDriver *ManyMouseDriver_evdev = &ManyMouseDriver_interface;
@@ -92,44 +92,6 @@ static inline int is_trackpad(const MouseStruct *mouse)
 } /* is_trackpad */
 
 
-/*
- * Just trying to avoid malloc() here...we statically allocate a buffer
- *  for events and treat it as a ring buffer.
- */
-/* !!! FIXME: tweak this? */
-#define MAX_EVENTS 1024
-static ManyMouseEvent input_events[MAX_EVENTS];
-static volatile int input_events_read = 0;
-static volatile int input_events_write = 0;
-
-static void queue_event(const ManyMouseEvent *event)
-{
-    /* copy the event info. We'll process it in ManyMouse_PollEvent(). */
-    memcpy(&input_events[input_events_write], event, sizeof (ManyMouseEvent));
-
-    input_events_write = ((input_events_write + 1) % MAX_EVENTS);
-
-    /* Ring buffer full? Lose oldest event. */
-    if (input_events_write == input_events_read)
-    {
-        /* !!! FIXME: we need to not lose mouse buttons here. */
-        input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-    } /* if */
-} /* queue_event */
-
-
-static int dequeue_event(ManyMouseEvent *event)
-{
-    if (input_events_read != input_events_write)  /* no events if equal. */
-    {
-        memcpy(event, &input_events[input_events_read], sizeof (*event));
-        input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-        return 1;
-    } /* if */
-    return 0;  /* no event. */
-} /* dequeue_event */
-
-
 /* returns non-zero if (a <= b). */
 typedef unsigned long long ui64;
 static inline int oldEvent(const AbsoluteTime *a, const AbsoluteTime *b)
@@ -154,7 +116,7 @@ static void unplugged_callback(void *ctx, IOReturn res, void *sender)
         memset(&ev, '\0', sizeof (ev));
         ev.type = MANYMOUSE_EVENT_DISCONNECT;
         ev.device = logical;
-        queue_event(&ev);
+        ManyMouse_QueueEvent(&ev);
 
         /* disable any physical devices that back the same logical mouse. */
         for (i = 0; i < physical_mice; i++)
@@ -207,7 +169,7 @@ static void input_callback(void *ctx, IOReturn res,
                         {
                             ev.type = MANYMOUSE_EVENT_RELMOTION;
                             ev.item = (usage == kHIDUsage_GD_X) ? 0 : 1;
-                            queue_event(&ev);
+                            ManyMouse_QueueEvent(&ev);
                         } /* if */
                         break;
 
@@ -215,7 +177,7 @@ static void input_callback(void *ctx, IOReturn res,
                         /*memcpy(&mouse->lastScrollTime, &event.timestamp, sizeof (AbsoluteTime)); */
                         ev.type = MANYMOUSE_EVENT_SCROLL;
                         ev.item = 0;  /* !!! FIXME: horiz scroll? */
-                        queue_event(&ev);
+                        ManyMouse_QueueEvent(&ev);
                         break;
 
                     /*default:  !!! FIXME: absolute motion? */
@@ -227,7 +189,7 @@ static void input_callback(void *ctx, IOReturn res,
         {
             ev.type = MANYMOUSE_EVENT_BUTTON;
             ev.item = ((int) usage) - 1;
-            queue_event(&ev);
+            ManyMouse_QueueEvent(&ev);
         } /* else if */
     } /* if */
 } /* input_callback */
@@ -360,8 +322,7 @@ static void macosx_hidmanager_quit(void)
     free(mice);
     mice = NULL;
 
-    memset(input_events, '\0', sizeof (input_events));
-    input_events_read = input_events_write = 0;
+    ManyMouse_QueueReset();
 } /* macosx_hidmanager_quit */
 
 
@@ -406,14 +367,15 @@ static const char *macosx_hidmanager_name(unsigned int index)
 static int macosx_hidmanager_poll(ManyMouseEvent *event)
 {
     /* ...favor existing events in the queue... */
-    if (dequeue_event(event))
+    if (ManyMouse_DequeueEvent(event))
         return 1;
 
     /* pump runloop for new hardware events... */
     while (CFRunLoopRunInMode(RUNLOOPMODE,0,TRUE)==kCFRunLoopRunHandledSource)
-        /* no-op. We're filling our queue... !!! FIXME: stop if queue fills. */ ;
+        /* no-op. We're filling our queue, which coalesces motion once full. */ ;
 
-    return dequeue_event(event);  /* see if anything had shown up... */
+    ManyMouse_QueueFlush();
+    return ManyMouse_DequeueEvent(event);  /* see if anything had shown up... */
 } /* macosx_hidmanager_poll */
 
 
@@ -423,7 +385,8 @@ static const ManyMouseDriver ManyMouseDriver_interface =
     macosx_hidmanager_init,
     macosx_hidmanager_quit,
     macosx_hidmanager_name,
-    macosx_hidmanager_poll
+    macosx_hidmanager_poll,
+    NULL  /* wait: not supported. */
 };
 
 const ManyMouseDriver *ManyMouseDriver_hidmanager = &ManyMouseDriver_interface;
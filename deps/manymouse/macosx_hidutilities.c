@@ -1715,7 +1715,8 @@ static const ManyMouseDriver ManyMouseDriver_interface =
     macosx_hidutilities_init,
     macosx_hidutilities_quit,
     macosx_hidutilities_name,
-    macosx_hidutilities_poll
+    macosx_hidutilities_poll,
+    NULL  /* wait: not supported. */
 };
 
 const ManyMouseDriver *ManyMouseDriver_hidutilities = &ManyMouseDriver_interface;
@@ -8,6 +8,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "manymouse.h"
 
 static const char *manymouse_copyright =
@@ -93,8 +94,159 @@ const char *ManyMouse_DeviceName(unsigned int index)
 
 int ManyMouse_PollEvent(ManyMouseEvent *event)
 {
+    if (event != NULL)
+        event->timestamp = 0;  /* drivers that can't stamp events leave it. */
     return (driver) ? driver->poll(event) : 0;
 } /* ManyMouse_PollEvent */
 
+int ManyMouse_WaitForInput(int timeout_ms)
+{
+    return ((driver) && (driver->wait)) ? driver->wait(timeout_ms) : -1;
+} /* ManyMouse_WaitForInput */
+
+
+/*
+ * Event queue. Just trying to avoid malloc() here...we statically allocate a
+ *  buffer for events and treat it as a ring buffer. (queue_write) is only
+ *  written by the producer and (queue_read) by the consumer, with release
+ *  stores and acquire loads. C11 atomics aren't an option, since this file is
+ *  also built as C++ (and by older compilers), so use the builtins.
+ */
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MANYMOUSE_LOAD_ACQUIRE(p) ((unsigned int) _InterlockedOr((volatile long *) (p), 0))
+#define MANYMOUSE_STORE_RELEASE(p, v) _InterlockedExchange((volatile long *) (p), (long) (v))
+#define MANYMOUSE_INCREMENT(p) _InterlockedIncrement((volatile long *) (p))
+#else
+#define MANYMOUSE_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define MANYMOUSE_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define MANYMOUSE_INCREMENT(p) __atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+#endif
+
+#define MAX_EVENTS 1024       /* must be a power of two. */
+#define MAX_PENDING_EVENTS 256 /* producer-side overflow while the ring is full. */
+
+static ManyMouseEvent input_events[MAX_EVENTS];
+static unsigned int input_events_read = 0;
+static unsigned int input_events_write = 0;
+static ManyMouseEvent pending_events[MAX_PENDING_EVENTS];  /* producer only. */
+static unsigned int pending_events_count = 0;
+static ManyMouseQueueStats queue_stats;
+
+
+static unsigned int queue_room(void)
+{
+    const unsigned int read = MANYMOUSE_LOAD_ACQUIRE(&input_events_read);
+    return MAX_EVENTS - (input_events_write - read);
+} /* queue_room */
+
+
+static void queue_push(const ManyMouseEvent *event)
+{
+    memcpy(&input_events[input_events_write & (MAX_EVENTS - 1)], event, sizeof (*event));
+    MANYMOUSE_STORE_RELEASE(&input_events_write, input_events_write + 1);
+    MANYMOUSE_INCREMENT(&queue_stats.queued);
+} /* queue_push */
+
+
+/* move overflowed events into the ring, oldest first. */
+static int flush_pending_events(void)
+{
+    unsigned int i = 0;
+    unsigned int room = queue_room();
+
+    while ((i < pending_events_count) && (room > 0))
+    {
+        queue_push(&pending_events[i++]);
+        room--;
+    } /* while */
+
+    pending_events_count -= i;
+    memmove(pending_events, pending_events + i, pending_events_count * sizeof (ManyMouseEvent));
+
+    return (pending_events_count == 0);
+} /* flush_pending_events */
+
+
+/* fold relative motion into a pending event of the same axis, if nothing else
+   from that device was queued after it (so button order is kept). */
+static int coalesce_pending_motion(const ManyMouseEvent *event)
+{
+    unsigned int i = pending_events_count;
+
+    while (i-- > 0)
+    {
+        ManyMouseEvent *pending = &pending_events[i];
+        if (pending->device != event->device)
+            continue;
+        else if (pending->type != MANYMOUSE_EVENT_RELMOTION)
+            return 0;  /* a button or such is in the way. */
+        else if (pending->item == event->item)
+        {
+            pending->value += event->value;
+            pending->timestamp = event->timestamp;  /* stamped with the newest. */
+            MANYMOUSE_INCREMENT(&queue_stats.coalesced);
+            return 1;
+        } /* else if */
+    } /* while */
+
+    return 0;
+} /* coalesce_pending_motion */
+
+
+void ManyMouse_QueueReset(void)
+{
+    memset(input_events, '\0', sizeof (input_events));
+    memset(&queue_stats, '\0', sizeof (queue_stats));
+    input_events_read = input_events_write = 0;
+    pending_events_count = 0;
+} /* ManyMouse_QueueReset */
+
+
+void ManyMouse_QueueEvent(const ManyMouseEvent *event)
+{
+    /* Ring buffer has room and nothing is waiting ahead of us? Fast path. */
+    if ((flush_pending_events()) && (queue_room() > 0))
+    {
+        queue_push(event);
+        return;
+    } /* if */
+
+    /* Ring buffer full? Keep it aside, merging relative motion. */
+    if ((event->type == MANYMOUSE_EVENT_RELMOTION) && (coalesce_pending_motion(event)))
+        return;
+
+    if (pending_events_count < MAX_PENDING_EVENTS)
+        memcpy(&pending_events[pending_events_count++], event, sizeof (*event));
+    else
+        MANYMOUSE_INCREMENT(&queue_stats.dropped);
+} /* ManyMouse_QueueEvent */
+
+
+void ManyMouse_QueueFlush(void)
+{
+    flush_pending_events();
+} /* ManyMouse_QueueFlush */
+
+
+int ManyMouse_DequeueEvent(ManyMouseEvent *event)
+{
+    const unsigned int read = input_events_read;
+    if (read == MANYMOUSE_LOAD_ACQUIRE(&input_events_write))
+        return 0;  /* no events if equal. */
+
+    memcpy(event, &input_events[read & (MAX_EVENTS - 1)], sizeof (*event));
+    MANYMOUSE_STORE_RELEASE(&input_events_read, read + 1);
+    return 1;
+} /* ManyMouse_DequeueEvent */
+
+
+void ManyMouse_GetQueueStats(ManyMouseQueueStats *stats)
+{
+    stats->queued = MANYMOUSE_LOAD_ACQUIRE(&queue_stats.queued);
+    stats->coalesced = MANYMOUSE_LOAD_ACQUIRE(&queue_stats.coalesced);
+    stats->dropped = MANYMOUSE_LOAD_ACQUIRE(&queue_stats.dropped);
+} /* ManyMouse_GetQueueStats */
+
 /* end of manymouse.c ... */
 
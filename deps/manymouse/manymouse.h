@@ -33,6 +33,7 @@ typedef struct
     int value;
     int minval;
     int maxval;
+    unsigned long long timestamp;  /* CLOCK_MONOTONIC nanoseconds, 0 if unknown. */
 } ManyMouseEvent;
 
 
@@ -44,6 +45,7 @@ typedef struct
     void (*quit)(void);
     const char *(*name)(unsigned int index);
     int (*poll)(ManyMouseEvent *event);
+    int (*wait)(int timeout_ms);  /* may be NULL. */
 } ManyMouseDriver;
 
 
@@ -53,6 +55,36 @@ void ManyMouse_Quit(void);
 const char *ManyMouse_DeviceName(unsigned int index);
 int ManyMouse_PollEvent(ManyMouseEvent *event);
 
+/*
+ * Block until some mouse has input or (timeout_ms) elapse (-1 waits forever).
+ *  Returns 1 if ManyMouse_PollEvent() has something to report, 0 on timeout,
+ *  and -1 if the driver can't wait, in which case keep polling instead.
+ */
+int ManyMouse_WaitForInput(int timeout_ms);
+
+typedef struct
+{
+    unsigned int queued;     /* events that made it into the queue. */
+    unsigned int coalesced;  /* relative motion folded into pending motion. */
+    unsigned int dropped;    /* events lost because queue and overflow were full. */
+} ManyMouseQueueStats;
+
+/* Counters of the event queue drivers fill from the platform's callbacks. */
+void ManyMouse_GetQueueStats(ManyMouseQueueStats *stats);
+
+/*
+ * internal use only: the event queue shared by the drivers. It is a lock-free
+ *  single-producer/single-consumer ring: queue and flush from the thread that
+ *  pumps platform events, dequeue from the thread that calls
+ *  ManyMouse_PollEvent(). When full, events wait in order in a small overflow
+ *  on the producer side, where relative motion is coalesced, so button
+ *  transitions aren't lost. QueueFlush() moves the overflow into the ring.
+ */
+void ManyMouse_QueueReset(void);
+void ManyMouse_QueueEvent(const ManyMouseEvent *event);
+void ManyMouse_QueueFlush(void);
+int ManyMouse_DequeueEvent(ManyMouseEvent *event);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,15 +29,6 @@
 /* that should be enough, knock on wood. */
 #define MAX_MICE 32
 
-/*
- * Just trying to avoid malloc() here...we statically allocate a buffer
- *  for events and treat it as a ring buffer.
- */
-/* !!! FIXME: tweak this? */
-#define MAX_EVENTS 1024
-static ManyMouseEvent input_events[MAX_EVENTS];
-static volatile int input_events_read = 0;
-static volatile int input_events_write = 0;
 static int available_mice = 0;
 static int did_api_lookup = 0;
 static HWND raw_hwnd = NULL;
@@ -198,22 +189,6 @@ static size_t string_length(const char *a)
 } /* string_length */
 
 
-static void queue_event(const ManyMouseEvent *event)
-{
-    /* copy the event info. We'll process it in ManyMouse_PollEvent(). */
-    CopyMemory(&input_events[input_events_write], event, sizeof (ManyMouseEvent));
-
-    input_events_write = ((input_events_write + 1) % MAX_EVENTS);
-
-    /* Ring buffer full? Lose oldest event. */
-    if (input_events_write == input_events_read)
-    {
-        /* !!! FIXME: we need to not lose mouse buttons here. */
-        input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-    } /* if */
-} /* queue_event */
-
-
 static void queue_from_rawinput(const RAWINPUT *raw)
 {
     int i;
@@ -233,6 +208,8 @@ static void queue_from_rawinput(const RAWINPUT *raw)
     if (i == available_mice)
         return;  /* not found?! */
 
+    ZeroMemory(&event, sizeof (event));  /* no timestamp: message time is GetTickCount(). */
+
     /*
      * RAWINPUT packs a bunch of events into one, so we split it up into
      *  a bunch of ManyMouseEvents here and store them in an internal queue.
@@ -250,10 +227,10 @@ static void queue_from_rawinput(const RAWINPUT *raw)
         event.type = MANYMOUSE_EVENT_ABSMOTION;
         event.item = 0;
         event.value = mouse->lLastX;
-        queue_event(&event);
+        ManyMouse_QueueEvent(&event);
         event.item = 1;
         event.value = mouse->lLastY;
-        queue_event(&event);
+        ManyMouse_QueueEvent(&event);
     } /* if */
 
     else /*if (mouse->usFlags & MOUSE_MOVE_RELATIVE)*/
@@ -263,14 +240,14 @@ static void queue_from_rawinput(const RAWINPUT *raw)
         {
             event.item = 0;
             event.value = mouse->lLastX;
-            queue_event(&event);
+            ManyMouse_QueueEvent(&event);
         } /* if */
 
         if (mouse->lLastY != 0)
         {
             event.item = 1;
             event.value = mouse->lLastY;
-            queue_event(&event);
+            ManyMouse_QueueEvent(&event);
         } /* if */
     } /* else if */
 
@@ -280,12 +257,12 @@ static void queue_from_rawinput(const RAWINPUT *raw)
         if (mouse->usButtonFlags & RI_MOUSE_BUTTON_##x##_DOWN) { \
             event.item = x-1; \
             event.value = 1; \
-            queue_event(&event); \
+            ManyMouse_QueueEvent(&event); \
         } \
         if (mouse->usButtonFlags & RI_MOUSE_BUTTON_##x##_UP) { \
             event.item = x-1; \
             event.value = 0; \
-            queue_event(&event); \
+            ManyMouse_QueueEvent(&event); \
         } \
     }
 
@@ -304,7 +281,7 @@ static void queue_from_rawinput(const RAWINPUT *raw)
             event.type = MANYMOUSE_EVENT_SCROLL;
             event.item = 0;  /* !!! FIXME: horizontal wheel? */
             event.value = ( ((SHORT) mouse->usButtonData) > 0) ? 1 : -1;
-            queue_event(&event);
+            ManyMouse_QueueEvent(&event);
         } /* if */
     } /* if */
 
@@ -352,8 +329,7 @@ static int init_event_queue(void)
     WNDCLASSEX wce;
     RAWINPUTDEVICE rid;
 
-    ZeroMemory(input_events, sizeof (input_events));
-    input_events_read = input_events_write = 0;
+    ManyMouse_QueueReset();
 
     ZeroMemory(&wce, sizeof (wce));
     wce.cbSize = sizeof(WNDCLASSEX);
@@ -653,14 +629,7 @@ static int windows_wminput_poll(ManyMouseEvent *ev)
     int found = 0;
 
     /* ...favor existing events in the queue... */
-    pEnterCriticalSection(&mutex);
-    if (input_events_read != input_events_write)  /* no events if equal. */
-    {
-        CopyMemory(ev, &input_events[input_events_read], sizeof (*ev));
-        input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-        found = 1;
-    } /* if */
-    pLeaveCriticalSection(&mutex);
+    found = ManyMouse_DequeueEvent(ev);
 
     if (!found)
     {
@@ -673,13 +642,9 @@ static int windows_wminput_poll(ManyMouseEvent *ev)
 
         /* In case something new came in, give it to the app... */
         pEnterCriticalSection(&mutex);
-        if (input_events_read != input_events_write)  /* no events if equal. */
-        {
-            CopyMemory(ev, &input_events[input_events_read], sizeof (*ev));
-            input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-            found = 1;
-        } /* if */
+        ManyMouse_QueueFlush();
         pLeaveCriticalSection(&mutex);
+        found = ManyMouse_DequeueEvent(ev);
     } /* if */
 
     /*
@@ -700,7 +665,8 @@ static const ManyMouseDriver ManyMouseDriver_interface =
     windows_wminput_init,
     windows_wminput_quit,
     windows_wminput_name,
-    windows_wminput_poll
+    windows_wminput_poll,
+    NULL  /* wait: not supported. */
 };
 
 const ManyMouseDriver *ManyMouseDriver_windows = &ManyMouseDriver_interface;
@@ -47,47 +47,6 @@ static Display *display = NULL;
 static int xi2_opcode = 0;
 
 
-/* !!! FIXME: this is cut-and-paste between a few targets now. Move it to
- * !!! FIXME:  manymouse.c ...
- */
-/*
- * Just trying to avoid malloc() here...we statically allocate a buffer
- *  for events and treat it as a ring buffer.
- */
-/* !!! FIXME: tweak this? */
-#define MAX_EVENTS 1024
-static ManyMouseEvent input_events[MAX_EVENTS];
-static volatile int input_events_read = 0;
-static volatile int input_events_write = 0;
-
-static void queue_event(const ManyMouseEvent *event)
-{
-    /* copy the event info. We'll process it in ManyMouse_PollEvent(). */
-    memcpy(&input_events[input_events_write], event, sizeof (ManyMouseEvent));
-
-    input_events_write = ((input_events_write + 1) % MAX_EVENTS);
-
-    /* Ring buffer full? Lose oldest event. */
-    if (input_events_write == input_events_read)
-    {
-        /* !!! FIXME: we need to not lose mouse buttons here. */
-        input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-    } /* if */
-} /* queue_event */
-
-
-static int dequeue_event(ManyMouseEvent *event)
-{
-    if (input_events_read != input_events_write)  /* no events if equal. */
-    {
-        memcpy(event, &input_events[input_events_read], sizeof (*event));
-        input_events_read = ((input_events_read + 1) % MAX_EVENTS);
-        return 1;
-    } /* if */
-    return 0;  /* no event. */
-} /* dequeue_event */
-
-
 /*
  * You _probably_ have Xlib on your system if you're on a Unix box where you
  *  are planning to plug in multiple mice. That being said, we don't want
@@ -190,8 +149,7 @@ static void xinput2_cleanup(void)
     LIBCLOSE(libx11);
     #undef LIBCLOSE
 
-    memset(input_events, '\0', sizeof (input_events));
-    input_events_read = input_events_write = 0;
+    ManyMouse_QueueReset();
 } /* xinput2_cleanup */
 
 
@@ -404,6 +362,8 @@ static void pump_events(void)
     XEvent xev;
     int i = 0;
 
+    memset(&event, '\0', sizeof (event));  /* no timestamp: X server time is 32-bit milliseconds. */
+
     while (get_next_x11_event(&xev))
     {
         /* All XI2 events are "cookie" events...which need extra tapdance. */
@@ -441,7 +401,7 @@ static void pump_events(void)
                             event.minval = mice[mouse].minval[i];
                             event.maxval = mice[mouse].maxval[i];
                             if ((!mice[mouse].relative[i]) || (value))
-                                queue_event(&event);
+                                ManyMouse_QueueEvent(&event);
                             values++;
                         } /* if */
                     } /* for */
@@ -475,7 +435,7 @@ static void pump_events(void)
                             else
                                 event.value = -1;
 
-                            queue_event(&event);
+                            ManyMouse_QueueEvent(&event);
                         } /* if */
                     } /* if */
                     else
@@ -484,7 +444,7 @@ static void pump_events(void)
                         event.device = mouse;
                         event.item = button-1;
                         event.value = pressed;
-                        queue_event(&event);
+                        ManyMouse_QueueEvent(&event);
                     } /* else */
                 } /* if */
                 break;
@@ -501,7 +461,7 @@ static void pump_events(void)
                             mice[mouse].connected = 0;
                             event.type = MANYMOUSE_EVENT_DISCONNECT;
                             event.device = mouse;
-                            queue_event(&event);
+                            ManyMouse_QueueEvent(&event);
                         } /* if */
                     } /* if */
                 } /* for */
@@ -514,11 +474,12 @@ static void pump_events(void)
 
 static int x11_xinput2_poll(ManyMouseEvent *event)
 {
-    if (dequeue_event(event))  /* ...favor existing events in the queue... */
+    if (ManyMouse_DequeueEvent(event))  /* ...favor existing events in the queue... */
         return 1;
 
     pump_events();  /* pump runloop for new hardware events... */
-    return dequeue_event(event);  /* see if anything had shown up... */
+    ManyMouse_QueueFlush();
+    return ManyMouse_DequeueEvent(event);  /* see if anything had shown up... */
 } /* x11_xinput2_poll */
 
 static const ManyMouseDriver ManyMouseDriver_interface =
@@ -527,7 +488,8 @@ static const ManyMouseDriver ManyMouseDriver_interface =
     x11_xinput2_init,
     x11_xinput2_quit,
     x11_xinput2_name,
-    x11_xinput2_poll
+    x11_xinput2_poll,
+    NULL  /* wait: not supported. */
 };
 
 const ManyMouseDriver *ManyMouseDriver_xinput2 = &ManyMouseDriver_interface;
@@ -3,7 +3,6 @@
  * Copyright (c) 2010,2011,2012,2013 Mario 'rlyeh' Rodriguez, zlib/libpng licensed
 
  * @todo:
- * - N should be seconds time rather than polling samples
  * - Send 'off' to buttons,lists,etc when windows focus is lost
  * - Proposal:
  *   at(   0) -> current value
@@ -16,12 +15,42 @@
 #pragma once
 
 #include <cassert>
+#include <cmath>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <deque>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef _MSC_VER
+#   include <intrin.h>                  // popcount, bitscan
+#endif
+
+// keyplane bulk queries use AVX2 or SSE2 when available. define HYDE_NO_SIMD to force scalar code.
+#if !defined(HYDE_NO_SIMD) && defined(__AVX2__)
+#   include <immintrin.h>
+#   define HYDE_SIMD_AVX2 1
+#elif !defined(HYDE_NO_SIMD) && ( defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) )
+#   include <emmintrin.h>
+#   define HYDE_SIMD_SSE2 1
+#endif
+
 // Platform independent key codes
 
 #ifdef _WIN32
@@ -30,6 +59,7 @@
 #endif
 
 #if defined(__linux__) || defined(__unix__)
+#   include <X11/keysym.h>
 #   define hyde$keycode( windows, linux, apple ) linux
 #endif
 
@@ -163,28 +193,187 @@ namespace hyde
 
 #undef hyde$keycode
 
+// session logs are read through memory mapped files
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
 
 namespace hyde
 {
     namespace hid
     {
+        // monotonic timestamps, in nanoseconds
+        typedef std::int64_t tick;
+
+        // observer of every history set(), as seen by the history (ie, hyde::recorder).
+        // values are the sample components, dims of them.
+        class listener
+        {
+            public:
+
+            virtual ~listener() {}
+            virtual void on_set( const void *control, const tick &t, const float *values, size_t dims ) = 0;
+        };
+
+        // manual time source: time only moves when told to, so gesture timings are reproducible.
+        // install it on a thread with hid::clock_scope (or per hub, see hyde::hub::set_clock()),
+        // and every hid::dt::now()/ticks() on that thread reads it instead of the system clock.
+        //
+        // hyde::hid::virtual_clock clock;
+        // hyde::hid::clock_scope scope( &clock );
+        // button.set( 0.5f ); clock.advance( 0.1 ); button.set( 0.f );   // a 100 ms tap
+        //
+        // s()/ms()/us()/ns() keep measuring real time, so hid::dt still works as a stopwatch.
+
+        class virtual_clock
+        {
+            tick current;
+
+            public:
+
+            explicit virtual_clock( const tick &start = 0 ) : current( start )
+            {}
+
+            tick now() const
+            {
+                return current;
+            }
+
+            void set( const tick &t )
+            {
+                current = t;
+            }
+
+            void advance( const double &seconds )
+            {
+                current += tick( seconds * 1000000000.0 );
+            }
+
+            void advance_ticks( const tick &dt )
+            {
+                current += dt;
+            }
+        };
+
+        // virtual clock in use by this thread, if any
+        inline virtual_clock *&thread_clock()
+        {
+            static thread_local virtual_clock *current = 0;
+            return current;
+        }
+
+        class clock_scope
+        {
+            virtual_clock *previous;
+
+            clock_scope( const clock_scope & );
+            clock_scope &operator =( const clock_scope & );
+
+            public:
+
+            explicit clock_scope( virtual_clock *clock ) : previous( thread_clock() )
+            {
+                thread_clock() = clock;
+            }
+
+            ~clock_scope()
+            {
+                thread_clock() = previous;
+            }
+        };
+
         class dt
         {
-            typedef std::chrono::high_resolution_clock clock;
+            typedef std::chrono::steady_clock clock;
             clock::time_point start;
 
+            // frame, tracking and listener state is kept per thread: a frame opened (or a listener
+            // installed) on one thread never freezes, tracks or records sets made on another one,
+            // so threads polling their own devices never race on hyde::global_timer.
+            struct thread_state
+            {
+                // frame-clock mode: while frozen, now() returns the tick captured at freeze()
+                // so every sample written in a poll cycle shares a single clock read
+                int frozen;
+                tick frame;
+
+                // controls whose value changed during current frame (see hyde::hub)
+                std::vector< const void * > *changes;
+
+                // gets every set() of every history made by this thread, if any
+                listener *observer;
+            };
+
+            // unique per timer, so states of a timer that is gone are never picked up by a new one
+            std::uint64_t serial;
+
+            static std::uint64_t next_serial()
+            {
+                static std::atomic< std::uint64_t > counter( 0 );
+                return ++counter;
+            }
+
+            thread_state &state() const
+            {
+                struct entry
+                {
+                    std::uint64_t serial;
+                    thread_state state;
+                };
+
+                // usually a single timer per thread: check the last one looked up first
+                static thread_local std::deque< entry > states;
+                static thread_local entry *last = 0;
+
+                if( last && last->serial == serial )
+                    return last->state;
+
+                for( auto &it : states )
+                    if( it.serial == serial )
+                        return ( last = &it )->state;
+
+                entry fresh = { serial, { 0, 0, 0, 0 } };
+                states.push_back( fresh );
+
+                return ( last = &states.back() )->state;
+            }
+
             public:
 
-            dt()
+            dt() : serial( next_serial() )
             {
                 start = clock::now();
             }
 
+            // same time base, own frame state
+            dt( const dt &other ) : start( other.start ), serial( next_serial() )
+            {}
+
+            dt &operator =( const dt &other )
+            {
+                start = other.start;
+                serial = next_serial();
+                return *this;
+            }
+
             void reset()
             {
                 *this = dt();
             }
 
+            // same time base, but none of the frame, tracking or listener state. other threads
+            // may also stamp with their own timebase() copy (see hyde::input_thread)
+            dt timebase() const
+            {
+                return dt( *this );
+            }
+
             double s()
             {
                 return std::chrono::nanoseconds( clock::now() - start ).count() / 1000000000.0; //::seconds
@@ -204,95 +393,431 @@ namespace hyde
             {
                 return std::chrono::nanoseconds( clock::now() - start ).count() / 1.0;
             }
+
+            tick ticks()
+            {
+                // a thread local load and a branch: cheaper than any system clock read
+                if( const virtual_clock *manual = thread_clock() )
+                    return manual->now();
+
+                return std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - start ).count();
+            }
+
+            tick now()
+            {
+                const thread_state &current = state();
+                return current.frozen ? current.frame : ticks();
+            }
+
+            // os timestamps in nanoseconds since the epoch (ie, evdev input_event.time) minus this
+            // offset are ticks. sample it once per batch of events, not per event
+            tick system_offset()
+            {
+                return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::system_clock::now().time_since_epoch() ).count() - ticks();
+            }
+
+            // same for CLOCK_MONOTONIC timestamps (ie, evdev after EVIOCSCLOCKID, ManyMouseEvent),
+            // which is what steady_clock reads on linux
+            tick monotonic_offset()
+            {
+                return std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now().time_since_epoch() ).count() - ticks();
+            }
+
+            // freeze(), track() and listen() only apply to the calling thread (see thread_state)
+            void freeze()
+            {
+                thread_state &current = state();
+
+                if( !current.frozen++ )
+                    current.frame = ticks();
+            }
+
+            void unfreeze()
+            {
+                thread_state &current = state();
+
+                assert( current.frozen > 0 );
+                --current.frozen;
+            }
+
+            std::vector< const void * > *track( std::vector< const void * > *sink )
+            {
+                thread_state &current = state();
+
+                std::vector< const void * > *previous = current.changes;
+                current.changes = sink;
+                return previous;
+            }
+
+            void touch( const void *control )
+            {
+                std::vector< const void * > *changes = state().changes;
+
+                if( changes && ( changes->empty() || changes->back() != control ) )
+                    changes->push_back( control );
+            }
+
+            listener *listen( listener *sink )
+            {
+                thread_state &current = state();
+
+                listener *previous = current.observer;
+                current.observer = sink;
+                return previous;
+            }
+
+            listener *listening() const
+            {
+                return state().observer;
+            }
+
+            void notify( const void *control, const tick &t, const float *values, size_t dims )
+            {
+                if( listener *observer = state().observer )
+                    observer->on_set( control, t, values, dims );
+            }
+
+            static tick to_ticks( const double &seconds )
+            {
+                return tick( seconds * 1000000000.0 );
+            }
+
+            static double to_seconds( const tick &t )
+            {
+                return t / 1000000000.0;
+            }
+        };
+
+        // scoped frame-clock: capture one now() for the whole poll cycle. nestable.
+        // optionally, collect every control that changes within the frame into 'changes'.
+        class frame
+        {
+            dt &timer;
+            std::vector< const void * > *previous;
+            bool tracking;
+
+            frame( const frame & );
+            frame &operator =( const frame & );
+
+            public:
+
+            explicit frame( dt &_timer, std::vector< const void * > *changes = 0 ) : timer(_timer), previous(0), tracking( changes != 0 )
+            {
+                timer.freeze();
+
+                if( tracking )
+                    previous = timer.track( changes );
+            }
+
+            ~frame()
+            {
+                if( tracking )
+                    timer.track( previous );
+
+                timer.unfreeze();
+            }
+        };
+
+        // ticks of the last two polls of a device, for controls it only sets when they change
+        // (see history::age_from())
+        struct polls
+        {
+            tick previous, last;
+
+            explicit polls( const tick &t = 0 ) : previous(t), last(t)
+            {}
+
+            void advance( const tick &t )
+            {
+                previous = last;
+                last = t;
+            }
+
+            // stamp for an event read during the poll in progress: newer than the last poll
+            tick within( const tick &t ) const
+            {
+                return t > last ? t : last + 1;
+            }
         };
     }
 
     extern hyde::hid::dt global_timer;
 
-    template< typename SAMPLE_TYPE, const int N = 120 >
-    class history : public SAMPLE_TYPE
+    // per-component access to samples (see hyde::types::hid)
+    namespace types
     {
-        // N samples = fixed deque of N samples
-        //
-        // (t0,sample0) (t1,sample1) ... (tN-1,sampleN-1)
-        // newest...oldest
-        //
-        // now = find_dt( dt = 0 ) -> iter #0
-        // Nth = find_dt( dt = 1 ) -> iter #N-1
-        //
-        // now = find_t( t = 0 secs ago ) -> iter #0
-        // then = find_t( t = T secs ago ) -> iter #N-1
-        //
-        // duration = t0 - tN
-        //
+        namespace hid
+        {
+            template <typename SAMPLE_TYPE>
+            struct traits;
+        }
+    }
 
-        // todo: catmull-rom/math9::stats lerp for previous positions (useful?)
-        // todo: burg to predict next positions (useful?)
+    // change rule of every history: a sample whose components all lie within the newest
+    // sample's treshold (inclusive, so a repeated value matches even with the default treshold
+    // of 0) is not reported as a change (see hid::dt::touch()), and is not pushed into lazily
+    // aged histories (see history::age_from()). kept apart from the strict SAMPLE_TYPE::operator==,
+    // which decides whether plain histories push it.
+    template< typename SAMPLE_TYPE >
+    bool same_sample( const SAMPLE_TYPE &newest, const SAMPLE_TYPE &sample )
+    {
+        typedef types::hid::traits< SAMPLE_TYPE > traits;
+
+        for( size_t d = 0; d < traits::dims; ++d )
+            if( std::abs( sample.*traits::value(d) - newest.*traits::value(d) ) > newest.treshold )
+                return false;
+
+        return true;
+    }
+
+    // random access iterator over a ring of N samples, newest first
 
-        std::deque< SAMPLE_TYPE > container;
+    template< typename SAMPLE_TYPE, const int N >
+    class history_iterator
+    {
+        const SAMPLE_TYPE *ring;
+        size_t head;
+        std::ptrdiff_t pos;
 
         public:
 
-        history() : container( N )
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef SAMPLE_TYPE value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const SAMPLE_TYPE *pointer;
+        typedef const SAMPLE_TYPE &reference;
+
+        history_iterator( const SAMPLE_TYPE *_ring = 0, size_t _head = 0, std::ptrdiff_t _pos = 0 ) : ring(_ring), head(_head), pos(_pos) {}
+
+        reference operator *() const { return ring[ ( head + pos ) % N ]; }
+        pointer operator ->() const { return &operator*(); }
+        reference operator []( difference_type n ) const { return *( *this + n ); }
+
+        history_iterator &operator ++() { ++pos; return *this; }
+        history_iterator &operator --() { --pos; return *this; }
+        history_iterator operator ++( int ) { history_iterator it( *this ); ++pos; return it; }
+        history_iterator operator --( int ) { history_iterator it( *this ); --pos; return it; }
+        history_iterator &operator +=( difference_type n ) { pos += n; return *this; }
+        history_iterator &operator -=( difference_type n ) { pos -= n; return *this; }
+        history_iterator operator +( difference_type n ) const { return history_iterator( ring, head, pos + n ); }
+        history_iterator operator -( difference_type n ) const { return history_iterator( ring, head, pos - n ); }
+        difference_type operator -( const history_iterator &it ) const { return pos - it.pos; }
+
+        bool operator ==( const history_iterator &it ) const { return pos == it.pos; }
+        bool operator !=( const history_iterator &it ) const { return pos != it.pos; }
+        bool operator  <( const history_iterator &it ) const { return pos  < it.pos; }
+        bool operator  >( const history_iterator &it ) const { return pos  > it.pos; }
+        bool operator <=( const history_iterator &it ) const { return pos <= it.pos; }
+        bool operator >=( const history_iterator &it ) const { return pos >= it.pos; }
+    };
+
+    // compile-time gesture patterns
+    //
+    // a pattern is a sequence of states (oldest first) followed by a time window, ie:
+    //   pattern< low, high, low, ms<500> >  ->  [then] low -> high -> low [now], all within 500 ms
+    //
+    // states are checked against the newest K samples with unchecked access, and are combined
+    // without short-circuits so a pattern compiles down to K compares plus the window check.
+
+    template< int PERMILLE > struct below { static bool test( double x ) { return x  < PERMILLE / 1000.0; } };
+    template< int PERMILLE > struct above { static bool test( double x ) { return x >= PERMILLE / 1000.0; } };
+
+    typedef below<500> low;
+    typedef above<500> high;
+
+    struct any { static bool test( double ) { return true; } };
+
+    // time windows. adjust() applies a runtime interval (see history_queries::match(interval_t))
+
+    template< long long US > struct us
+    {
+        static hid::tick shortest() { return 0; }
+        static hid::tick longest() { return US * 1000LL; }
+        static void adjust( hid::tick interval, hid::tick &, hid::tick &longest ) { longest = interval; }
+    };
+    template< long long MS > struct ms : us< MS * 1000LL > {};
+    template< typename DURATION > struct longer_than
+    {
+        static hid::tick shortest() { return DURATION::longest() + 1; }
+        static hid::tick longest() { return (std::numeric_limits< hid::tick >::max)(); }
+        static void adjust( hid::tick interval, hid::tick &shortest, hid::tick & ) { shortest = interval + 1; }
+    };
+    struct forever
+    {
+        static hid::tick shortest() { return 0; }
+        static hid::tick longest() { return (std::numeric_limits< hid::tick >::max)(); }
+        static void adjust( hid::tick, hid::tick &, hid::tick & ) {}
+    };
+    struct anytime : forever
+    {
+        static void adjust( hid::tick interval, hid::tick &, hid::tick &longest ) { longest = interval; }
+    };
+
+    template< size_t K, typename... ARGS >
+    struct pattern_states;
+
+    template< size_t K, typename WINDOW >
+    struct pattern_states< K, WINDOW >
+    {
+        static const size_t samples = K;
+        typedef WINDOW window;
+
+        template< typename IT >
+        static bool test( const IT & )
         {
-            clear();
-            std::reverse( container.begin(), container.end() );
+            return true;
+        }
+    };
+
+    template< size_t K, typename STATE, typename NEXT, typename... REST >
+    struct pattern_states< K, STATE, NEXT, REST... >
+    {
+        typedef pattern_states< K + 1, NEXT, REST... > next;
+        static const size_t samples = next::samples;
+        typedef typename next::window window;
+
+        template< typename IT >
+        static bool test( const IT &newest )
+        {
+            return STATE::test( newest[ samples - 1 - K ].x ) & next::test( newest );
         }
+    };
 
-        size_t size() const
+    // samples of a lazily aged history that was not set during the last poll, as if it had
+    // been: newest sample repeated once, stamped at the last poll (see history::aged())
+    template< typename ITERATOR, typename SAMPLE_TYPE >
+    class aged_iterator
+    {
+        ITERATOR newest;
+        hid::tick polled;
+
+        public:
+
+        aged_iterator( const ITERATOR &_newest, const hid::tick &_polled ) : newest(_newest), polled(_polled)
+        {}
+
+        SAMPLE_TYPE operator []( size_t n ) const
         {
-            return container.size();
+            SAMPLE_TYPE sample = newest[ n ? n - 1 : 0 ];
+
+            if( n < 2 )
+                sample.t = polled;
+
+            return sample;
+        }
+    };
+
+    template< typename... ARGS >
+    struct pattern
+    {
+        typedef pattern_states< 0, ARGS... > states;
+        typedef typename states::window window;
+        static const size_t samples = states::samples;
+
+        template< typename HISTORY >
+        static bool match( const HISTORY &h, hid::tick shortest = window::shortest(), hid::tick longest = window::longest() )
+        {
+            if( h.size() < samples )
+                return false;
+
+            typedef typename HISTORY::const_iterator iterator;
+            typedef typename std::decay< decltype( h.begin()[0] ) >::type sample;
+
+            if( h.aged() )
+                return match( aged_iterator< iterator, sample >( h.begin(), h.newest_t() ), h.newest_t(), shortest, longest );
+
+            return match( h.begin(), h.newest_t(), shortest, longest );
         }
 
-        void clear()
+        private:
+
+        template< typename IT >
+        static bool match( const IT &newest, const hid::tick &now, const hid::tick &shortest, const hid::tick &longest )
         {
-            double s = global_timer.s();
+            hid::tick lapse = now - newest[ samples - 1 ].t;
 
-            for( size_t i = 0; i < N; ++i )
-                container.at(i).t = s;
+            return ( lapse >= shortest ) & ( lapse <= longest ) & states::test( newest );
+        }
+    };
+
+    namespace patterns
+    {
+        typedef pattern< low, low, anytime > idle;
+        typedef pattern< low, high, anytime > trigger;
+        typedef pattern< high, forever > hold;
+        typedef pattern< high, low, anytime > release;
+        typedef pattern< low, high, low, ms<500> > click;
+        typedef pattern< low, high, low, high, low, ms<500> > dclick;
+        typedef pattern< low, high, low, high, low, high, low, ms<750> > tclick;
+        typedef pattern< low, high, longer_than< ms<500> > > longpress;
+    }
+
+    template< typename SAMPLE_TYPE, typename ITERATOR >
+    class history_view;
+
+    // queries shared by histories, views and copies.
+    // DERIVED provides begin(), end(), size(), at() and duration(), newest first.
+
+    template< typename DERIVED, typename SAMPLE_TYPE, typename ITERATOR >
+    class history_queries
+    {
+        const DERIVED &self() const
+        {
+            return static_cast< const DERIVED & >( *this );
         }
 
-        typename std::deque< SAMPLE_TYPE >::const_iterator newest_it() const   // ~recent(), ~current()
+        public:
+
+        typedef ITERATOR const_iterator;
+        typedef history_view< SAMPLE_TYPE, ITERATOR > view;
+
+        const_iterator newest_it() const   // ~recent(), ~current()
         {
-            assert( container.size() );
-            return container.begin();
+            assert( self().size() );
+            return self().begin();
         }
 /* TO_DEPRECATE
-        typename std::deque< SAMPLE_TYPE >::const_iterator oldest_it() const
+        const_iterator oldest_it() const
         {
-            assert( container.size() );
-            return container.end() - 1;
+            return self().end() - 1;
         }
 */
         const SAMPLE_TYPE &newest() const
         {
             return *newest_it();
         }
+
+        // timestamp of newest sample (may be newer than newest().t, see history::age_from())
+        hid::tick newest_t() const
+        {
+            return newest_it()->t;
+        }
+
+        // newest sample stands for the last poll too (see history::aged())
+        bool aged() const
+        {
+            return false;
+        }
 /* TO_DEPRECATE
         const SAMPLE_TYPE &oldest() const
         {
             return *oldest_it();
         }
 */
-        const double duration() const
-        {
-            return container.at(1).t - container.back().t;
-        }
-
-        typename std::deque< SAMPLE_TYPE >::const_iterator find_dt( const double &dt01 ) const
+        const_iterator find_dt( const double &dt01 ) const
         {
             // 0 = newest ... 1 = oldest
 
-            assert( container.size() );
+            assert( self().size() );
 
-            size_t dtpos = size_t( dt01 * container.size() );
+            size_t dtpos = size_t( dt01 * self().size() );
 
-            if( dtpos >= container.size() )
-                dtpos = container.size() - 1;
+            if( dtpos >= self().size() )
+                dtpos = self().size() - 1;
 
-            return container.begin() + dtpos;
+            return self().begin() + dtpos;
         }
-        typename std::deque< SAMPLE_TYPE >::const_iterator find_t( const double &seconds_ago ) const
+        const_iterator find_t( const double &seconds_ago ) const
         {
             // if seconds_ago_lapse <= 0 then return newest() iterator
             // if seconds_ago_lapse = ~0 then return iterator(s) close to newest()
@@ -300,24 +825,34 @@ namespace hyde
             // if seconds_ago_lapse = ~N then return iterator(s) close to oldest()
             // if seconds_ago_lapse >= N then return oldest() iterator
 
-            assert( container.size() );
+            assert( self().size() );
 
             if( seconds_ago <= 0 )
-                return begin();
+                return self().begin();
 
-            if( seconds_ago >= duration() )
-                return end() - 1;
+            if( seconds_ago >= self().duration() )
+                return self().end() - 1;
+
+            hid::tick current_time = self().newest_t();
+            hid::tick time_target = current_time - hid::dt::to_ticks( seconds_ago );
+
+            return find_t( self().begin(), time_target );
+        }
+        std::pair< const_iterator, const_iterator > find_t_range( const double &from_t, const double &to_t ) const
+        {
+            // same as { find_t( from_t ), find_t( to_t ) }, but second search is narrowed to [from,end)
 
-            double current_time = begin()->t;
-            double time_target = current_time - seconds_ago;
+            const_iterator from = find_t( from_t );
+
+            if( to_t <= from_t )
+                return std::make_pair( from, from );
 
-            const_iterator it;
+            if( to_t >= self().duration() )
+                return std::make_pair( from, self().end() - 1 );
 
-            for( it = container.begin(); it != container.end(); ++it )
-                if( time_target >= it->t )
-                    return it;
+            hid::tick time_target = self().newest_t() - hid::dt::to_ticks( to_t );
 
-            return end() - 1;
+            return std::make_pair( from, find_t( from, time_target ) );
         }
 
         const SAMPLE_TYPE &then_dt( const double &dt ) const
@@ -329,295 +864,590 @@ namespace hyde
             return *find_t( seconds_ago_lapse );
         }
 
-        history interval_dt( const double &from_01, const double &to_01 ) const
+        // intervals are non-owning views over [from,to) samples: no allocations, no copies.
+        // use view::copy() to get an owning hyde::history_copy instead.
+
+        view interval_dt( const double &from_01, const double &to_01 ) const
         {
             const_iterator from = find_dt( from_01 );
             const_iterator to = find_dt( to_01 );
 
             assert( (to - from) && "invalid interval" );
 
-            size_t N = to - from;
-
-            history h( N );
-
-            std::copy( from, to, h.begin() );
-
-            return h;
+            return view( from, to );
         }
-        history interval_t( const double &from_t, const double &to_t ) const
+        view interval_t( const double &from_t, const double &to_t ) const
         {
-            const_iterator from = find_t( from_t );
-            const_iterator to = find_t( to_t );
+            std::pair< const_iterator, const_iterator > range = find_t_range( from_t, to_t );
 
-            assert( (to - from) && "invalid interval" );
+            assert( (range.second - range.first) && "invalid interval" );
 
-            size_t N = to - from;
+            return view( range.first, range.second );
+        }
 
-            history h( N );
+        // pattern matching {
 
-            std::copy( from, to, h.begin() );
+            // @todo
+            // los patterns estaria mejor que dieran un gestalt o un valor aproximado segun encuentren
+            // un patron o no. tiene mas sentido; mejor que devolver un booleano. ademas enlazo ya
+            // con los gestures : )
 
-            return h;
-        }
+            // match any hyde::pattern<> against newest samples, ie:
+            //   key.match< hyde::pattern< low, high, low, high, low, high, low, ms<750> > >()
+            template< typename PATTERN >
+            bool match() const
+            {
+                return PATTERN::match( self() );
+            }
 
-        private:
+            // same, but overriding the pattern's time window
+            template< typename PATTERN >
+            bool match( float interval_t ) const
+            {
+                hid::tick shortest = PATTERN::window::shortest(), longest = PATTERN::window::longest();
+                PATTERN::window::adjust( hid::dt::to_ticks( interval_t ), shortest, longest );
+                return PATTERN::match( self(), shortest, longest );
+            }
 
-        void update_timestamp( int pos )
-        {
-            container.at( pos ).t = global_timer.s();
-        }
+            // idle: low [then] -> low [now]
+            // edges hold for a single poll already, so intervals are optional: idle(interval_t),
+            // trigger(interval_t) and release(interval_t) also ask the edge to be that recent
+            bool idle() const
+            {
+                return match< patterns::idle >();
+            }
+            bool idle( float interval_t ) const
+            {
+                return match< patterns::idle >( interval_t );
+            }
 
-        //public:
+            // trigger: [then] low -> high [now]
+            bool trigger() const
+            {
+                return match< patterns::trigger >();
+            }
+            bool trigger( float interval_t ) const
+            {
+                return match< patterns::trigger >( interval_t );
+            }
 
-        // set: function that push_front's element when relevant
+            // hold: high [now]
+            bool hold() const
+            {
+                return match< patterns::hold >();
+            }
 
-        void set( const SAMPLE_TYPE &new_sample )
-        {
-            if( new_sample == container.front() )   // update timestamp if value same than previous (~rle), insert if new value is relevant ~treshold
+            // release: [then] high -> low [now]
+            bool release() const
             {
-                update_timestamp(0); //y del resto... //useful?
+                return match< patterns::release >();
             }
-            else
+            bool release( float interval_t ) const
             {
-                // @todo: hago el resto... useful?
-                //update_timestamp(N-1);
-                //...
-                //update_timestamp(1);
-                update_timestamp(0);
+                return match< patterns::release >( interval_t );
+            }
+
+            // click: [then] low -> high -> low [now]       // also: peak, tap
+            bool click( float interval_t = 0.500f ) const
+            {
+                return match< patterns::click >( interval_t );
+            }
+
+            // dclick: [then] low -> high -> low -> high -> low [now]
+            bool dclick( float interval_t = 0.500f ) const
+            {
+                return match< patterns::dclick >( interval_t );
+            }
+
+            // tclick: [then] low -> high -> low -> high -> low -> high -> low [now]
+            bool tclick( float interval_t = 0.750f ) const
+            {
+                return match< patterns::tclick >( interval_t );
+            }
 
-                #if 1
-                // @todo: keep treshold and other members from current deque
-                container.push_front( container.front() );
-                container.front().set( new_sample );
-                #else
-                container.push_front( new_sample );
-                #endif
-                container.front().t = global_timer.s();
+            // longpress: [then] low -> high [now], high for 0.5 seconds at least
+            bool longpress() const
+            {
+                return match< patterns::longpress >();
+            }
+
+        // }
+
+        protected:
+
+        const_iterator find_t( const_iterator first, const hid::tick &time_target ) const
+        {
+            // timestamps are monotonic (newest first), so binary search first sample at or before time_target.
+            // newest sample is checked apart, as its timestamp may be aged lazily (see newest_t())
 
-                if( container.size() > N )
-                    container.pop_back();
+            if( first == self().begin() )
+            {
+                if( self().newest_t() <= time_target )
+                    return first;
+
+                ++first;
             }
 
-            import( newest() );
+            struct newer_than
+            {
+                bool operator()( const SAMPLE_TYPE &sample, const hid::tick &t ) const
+                {
+                    return sample.t > t;
+                }
+            };
+
+            const_iterator it = std::lower_bound( first, self().end(), time_target, newer_than() );
+
+            return it != self().end() ? it : self().end() - 1;
         }
+    };
+
+    // owning copy of a range of samples (newest first). cheap to move.
+
+    template< typename SAMPLE_TYPE >
+    class history_copy : public history_queries< history_copy< SAMPLE_TYPE >, SAMPLE_TYPE, typename std::vector< SAMPLE_TYPE >::const_iterator >
+    {
+        std::vector< SAMPLE_TYPE > samples;
 
         public:
 
-        // sugars{
+        typedef typename std::vector< SAMPLE_TYPE >::const_iterator const_iterator;
 
-        template <typename T>
-        void set( const T &t0 )
+        template< typename IT >
+        history_copy( IT first, IT last ) : samples( first, last )
+        {}
+
+        history_copy( const history_copy &other ) : samples( other.samples )
+        {}
+
+        history_copy( history_copy &&other ) : samples( std::move( other.samples ) )
+        {}
+
+        history_copy &operator =( const history_copy &other )
         {
-            set( SAMPLE_TYPE(t0) );
+            samples = other.samples;
+            return *this;
         }
 
-        template <typename T>
-        void set( const T &t0, const T &t1 )
+        history_copy &operator =( history_copy &&other )
         {
-            set( SAMPLE_TYPE(t0,t1) );
+            samples = std::move( other.samples );
+            return *this;
         }
 
-        template <typename T>
-        void set( const T &t0, const T &t1, const T &t2 )
+        size_t size() const
         {
-            set( SAMPLE_TYPE(t0,t1,t2) );
+            return samples.size();
         }
 
+        const_iterator begin() const
+        {
+            return samples.begin();
+        }
 
+        const_iterator end() const
+        {
+            return samples.end();
+        }
 
-        //}
+        const SAMPLE_TYPE &at( size_t pos ) const
+        {
+            assert( pos < samples.size() );
+            return samples[ pos ];
+        }
 
-        // pattern matching {
+        const double duration() const
+        {
+            return samples.size() < 2 ? 0 : hid::dt::to_seconds( samples.front().t - samples.back().t );
+        }
+    };
 
-            // @todo
-            // los patterns estaria mejor que dieran un gestalt o un valor aproximado segun encuentren
-            // un patron o no. tiene mas sentido; mejor que devolver un booleano. ademas enlazo ya
-            // con los gestures : )
+    // non-owning view of a range of samples (newest first)
 
-#if 1
-            // idle: low [then] -> low [now]
-            bool idle( float interval_t = 0.0125f ) //interval useful here?
-            {
-                double then_t = container.at(1).t;
-                double  now_t = container.at(0).t;
+    template< typename SAMPLE_TYPE, typename ITERATOR >
+    class history_view : public history_queries< history_view< SAMPLE_TYPE, ITERATOR >, SAMPLE_TYPE, ITERATOR >
+    {
+        ITERATOR first, last;
 
-                if( now_t - then_t > interval_t )
-                    return false; //time exceeded
+        public:
 
-                double then = container.at(1).x;
-                double  now = container.at(0).x;
+        history_view( ITERATOR _first, ITERATOR _last ) : first(_first), last(_last)
+        {}
 
-                return then < 0.5f && now < 0.5f;
-            }
-#else
-            // original code. conflict with release()
-            // idle: low [now]
-            bool idle()
-            {
-                double now = container.at(0).x;
+        size_t size() const
+        {
+            return size_t( last - first );
+        }
 
-                return now < 0.5f;
-            }
-#endif
+        bool empty() const
+        {
+            return first == last;
+        }
 
-            // trigger: [then] low -> high [now]
-            bool trigger( float interval_t = 0.0125f ) //interval useful here?
-            {
-                double then_t = container.at(1).t;
-                double  now_t = container.at(0).t;
+        ITERATOR begin() const
+        {
+            return first;
+        }
 
-                if( now_t - then_t > interval_t )
-                    return false; //time exceeded
+        ITERATOR end() const
+        {
+            return last;
+        }
 
-                double then = container.at(1).x;
-                double  now = container.at(0).x;
+        const SAMPLE_TYPE &at( size_t pos ) const
+        {
+            assert( pos < size() );
+            return first[ pos ];
+        }
 
-                return then < 0.5f && now >= 0.5f;
-            }
+        const double duration() const
+        {
+            return size() < 2 ? 0 : hid::dt::to_seconds( first->t - ( last - 1 )->t );
+        }
 
-            // hold: high [now]
-            bool hold()
-            {
-                double now = container.at(0).x;
+        history_copy< SAMPLE_TYPE > copy() const
+        {
+            return history_copy< SAMPLE_TYPE >( first, last );
+        }
+    };
 
-                return now >= 0.5f;
-            }
+    template< typename SAMPLE_TYPE, const int N = 120 >
+    class history : public SAMPLE_TYPE, public history_queries< history< SAMPLE_TYPE, N >, SAMPLE_TYPE, history_iterator< SAMPLE_TYPE, N > >
+    {
+        // N samples = fixed ring of N samples
+        //
+        // (t0,sample0) (t1,sample1) ... (tN-1,sampleN-1)
+        // newest...oldest
+        //
+        // now = find_dt( dt = 0 ) -> iter #0
+        // Nth = find_dt( dt = 1 ) -> iter #N-1
+        //
+        // now = find_t( t = 0 secs ago ) -> iter #0
+        // then = find_t( t = T secs ago ) -> iter #N-1
+        //
+        // duration = t0 - tN
+        //
+        // storage is a std::array used as a ring: 'head' indexes the newest sample and
+        // pushing a new sample just moves 'head' one slot backwards, recycling the oldest
+        // slot. no allocations after construction.
+        //
+        // every set() pushes a sample, so edge predicates (trigger, release...) hold for a single
+        // poll when a device sets the control every poll. histories aged from a hid::polls only
+        // keep changes instead (see age_from()).
+        //
+        // lookups, intervals and gesture predicates live in hyde::history_queries.
+        //
 
-            // release: [then] high -> low [now]
-            bool release( float interval_t = 0.0125f ) //interval useful here?
-            {
-                double then_t = container.at(1).t;
-                double  now_t = container.at(0).t;
+        // todo: catmull-rom/math9::stats lerp for previous positions (useful?)
+        // todo: burg to predict next positions (useful?)
 
-                if( now_t - then_t > interval_t )
-                    return false; //time exceeded
+        std::array< SAMPLE_TYPE, N > container;
+        size_t head;
 
-                double then = container.at(1).x;
-                double  now = container.at(0).x;
+        // lazy aging (opt-in run-length): when set, only changes get a new sample and the newest
+        // sample is considered refreshed up to polled->last. devices then skip set() on unchanged
+        // controls and advance a single shared hid::polls instead
+        const hid::polls *polled;
 
-                return then >= 0.5f && now < 0.5f;
-            }
+        public:
 
-            // click: [then] low -> high -> low [now]       // also: peak, tap
-            bool click( float interval_t = 0.500f )
-            {
-                double then_t = container.at(2).t;
-                double  now_t = container.at(0).t;
+        typedef history_iterator< SAMPLE_TYPE, N > const_iterator;
+
+        history() : head(0), polled(0)
+        {
+            clear();
+        }
 
-                if( now_t - then_t > interval_t )
-                    return false; //time exceeded
+        void age_from( const hid::polls *device_polls )
+        {
+            polled = device_polls;
+        }
 
-                double then = container.at(2).x;
-                double  mid = container.at(1).x;
-                double  now = container.at(0).x;
+        hid::tick newest_t() const
+        {
+            const hid::tick &t = at(0).t;
+            return polled && polled->last > t ? polled->last : t;
+        }
 
-                return then < 0.5f && mid >= 0.5f && now < 0.5f;
-            }
+        // lazily aged, and not set since the previous poll: to gesture patterns, newest sample
+        // is pushed again at the last poll, so edges last exactly one poll as if set() was called
+        // every poll
+        bool aged() const
+        {
+            return polled && at(0).t <= polled->previous;
+        }
 
-            // click: [then] low -> high -> low -> high -> low [now]
-            bool dclick( float interval_t = 0.500f )
-            {
-                double then_t = container.at(4).t;
-                double  now_t = container.at(0).t;
+        size_t size() const
+        {
+            return N;
+        }
 
-                if( now_t - then_t > interval_t )
-                    return false; //time exceeded
+        void clear()
+        {
+            clear( global_timer.now() );
+        }
 
-                double then = container.at(4).x;
-                double mid1 = container.at(3).x;
-                double  mid = container.at(2).x;
-                double mid2 = container.at(1).x;
-                double  now = container.at(0).x;
+        // same, stamped at 'now' (ie, a tick shared by every control of a device)
+        void clear( const hid::tick &now )
+        {
+            for( size_t i = 0; i < N; ++i )
+                container[i].t = now;
+        }
 
-                bool b0 = then >= 0.5f;
-                bool b1 = mid1 >= 0.5f;
-                bool b2 =  mid >= 0.5f;
-                bool b3 = mid2 >= 0.5f;
-                bool b4 =  now >= 0.5f;
+        // forget every sample: whole history becomes 'sample', stamped at t (ie, when seeking a replay)
+        void reset( const SAMPLE_TYPE &sample, const hid::tick &t )
+        {
+            SAMPLE_TYPE fill( sample );
+            fill.treshold = at(0).treshold;
+            fill.t = t;
 
-                return then < 0.5f && mid1 >= 0.5f && mid < 0.5f && mid2 >= 0.5f && now < 0.5f;
-            }
+            container.fill( fill );
+            head = 0;
 
-        // }
-    };
-}
+            this->import( this->newest() );
+        }
 
-namespace hyde
-{
-    namespace types
-    {
-        namespace hid
+        const_iterator begin() const
         {
-            struct string
-            {
-                double t;
-                std::string x;
-            };
+            return const_iterator( container.data(), head, 0 );
+        }
 
-            template <typename T>
-            struct vec1
-            {
-                double t;
-                float treshold;
-                T x, xdt;
+        const_iterator end() const
+        {
+            return const_iterator( container.data(), head, N );
+        }
 
-                vec1( const T &t0 = T() ) : t(0),treshold(0.0f),x(t0),xdt(0) {}
-                vec1( const vec1 &v ) { operator=(v); }
-                vec1 &operator =( const vec1 &v ) { if( this != &v ) t = v.t, treshold = v.treshold, x = v.x, xdt = v.xdt; return *this; }
-                void set( const vec1 &v ) { xdt = v.x - x; x = v.x; }
-                const bool operator ==( const vec1 &v ) const { return std::abs( x - v.x ) < treshold; }
-                void import( const vec1 &v )
-                    { operator=( v ); };
-            };
+        const SAMPLE_TYPE &at( size_t pos ) const
+        {
+            assert( pos < N );
+            return container[ ( head + pos ) % N ];
+        }
 
-            template <typename T>
-            struct vec2
-            {
-                double t;
-                float treshold;
-                T x, y, xdt, ydt;
+        const double duration() const
+        {
+            return hid::dt::to_seconds( at(1).t - at(N-1).t );
+        }
 
-                vec2( const T &t0 = T(), const T &t1 = T() ) : t(0),treshold(0.0f),x(t0),y(t1),xdt(0),ydt(0) {}
-                vec2( const vec2 &v ) { operator=(v); }
-                vec2 &operator =( const vec2 &v ) { if( this != &v ) t = v.t, treshold = v.treshold, x = v.x, y = v.y, xdt = v.xdt, ydt = v.ydt; return *this; }
-                void set( const vec2 &v ) { xdt = v.x - x, ydt = v.y - y; x = v.x, y = v.y; }
-                const bool operator ==( const vec2 &v ) const { return std::abs( x - v.x ) < treshold && std::abs( y - v.y ) < treshold; }
-                void import( const vec2 &v )
-                    { operator=( v ); };
-            };
+        private:
 
-            template <typename T>
-            struct vec3
-            {
-                double t;
-                float treshold;
-                T x, y, z, xdt, ydt, zdt;
+        void notify( const SAMPLE_TYPE &sample, const hid::tick &now )
+        {
+            typedef types::hid::traits< SAMPLE_TYPE > traits;
 
-                vec3( const T &t0 = T(), const T &t1 = T(), const T &t2 = T() ) : t(0),treshold(0.0f),x(t0),y(t1),z(t2),xdt(0),ydt(0),zdt(0) {}
-                vec3( const vec3 &v ) { operator=(v); }
-                vec3 &operator =( const vec3 &v ) { if( this != &v ) t = v.t, treshold = v.treshold, x = v.x, y = v.y, z = v.z, xdt = v.xdt, ydt = v.ydt, zdt = v.zdt; return *this; }
-                void set( const vec3 &v ) { xdt = v.x - x, ydt = v.y - y, zdt = v.z - z; x = v.x, y = v.y, z = v.z; }
-                const bool operator ==( const vec3 &v ) const { return std::abs( x - v.x ) < treshold && std::abs( y - v.y ) < treshold && std::abs( z - v.z ) < treshold; }
-                void import( const vec3 &v )
-                    { operator=( v ); };
-            };
+            float values[ traits::dims ];
+            for( size_t d = 0; d < traits::dims; ++d )
+                values[d] = float( sample.*traits::value(d) );
+
+            global_timer.notify( this, now, values, traits::dims );
         }
 
-        namespace wip_hid
+        void update_timestamp( int pos, const hid::tick &now )
         {
-            // normalized data [ -1, +1 ] for HIDs (human interface devices)
+            container[ ( head + pos ) % N ].t = now;
+        }
 
-            template <const int N, typename T = float>
-            struct vec
-            {
-                T elem[ N ];
+        //public:
 
-                vec()
-                    { for( size_t i = 0; i < N; ++i ) elem[ i ] = 0; }
-                vec( const vec<N,T> &v )
-                    { operator=( v.elem ); }
-                vec( const T *v )
-                    { operator=( v ); }
+        // set: function that push_front's element when relevant
+
+        void set( const SAMPLE_TYPE &new_sample )
+        {
+            set( new_sample, global_timer.now() );
+        }
+
+        void set( const SAMPLE_TYPE &new_sample, hid::tick now )
+        {
+            // samples stay sorted (newest first) even if events arrive stamped out of order
+            if( now < this->newest().t )
+                now = this->newest().t;
+
+            notify( new_sample, now );
+
+            // lazily aged: only changes are pushed, the newest sample ages from 'polled' meanwhile
+            if( polled && same_sample( this->newest(), new_sample ) )
+                return;
+
+            if( new_sample == this->newest() )   // update timestamp if value same than previous (~rle), insert if new value is relevant ~treshold
+            {
+                update_timestamp(0, now); //y del resto... //useful?
+            }
+            else
+            {
+                // @todo: hago el resto... useful?
+                //update_timestamp(N-1);
+                //...
+                //update_timestamp(1);
+                update_timestamp(0, now);
+
+                // recycle oldest slot as the new front (keeps treshold and other members from current front)
+                size_t front = head;
+                head = ( head + N - 1 ) % N;
+
+                container[ head ] = container[ front ];
+                container[ head ].set( new_sample );
+                container[ head ].t = now;
+
+                if( !same_sample( container[ front ], new_sample ) )
+                    global_timer.touch( this );
+            }
+
+            this->import( this->newest() );
+        }
+
+        public:
+
+        // sugars{
+
+        template <typename T>
+        void set( const T &t0 )
+        {
+            set( SAMPLE_TYPE(t0) );
+        }
+
+        template <typename T>
+        void set( const T &t0, const T &t1 )
+        {
+            set( SAMPLE_TYPE(t0,t1) );
+        }
+
+        template <typename T>
+        void set( const T &t0, const T &t1, const T &t2 )
+        {
+            set( SAMPLE_TYPE(t0,t1,t2) );
+        }
+
+        // same, stamped at tick 't' instead of global_timer.now() (ie, when the event was read)
+
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0 )
+        {
+            set( SAMPLE_TYPE(t0), t );
+        }
+
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0, const T &t1 )
+        {
+            set( SAMPLE_TYPE(t0,t1), t );
+        }
+
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0, const T &t1, const T &t2 )
+        {
+            set( SAMPLE_TYPE(t0,t1,t2), t );
+        }
+
+        //}
+    };
+}
+
+namespace hyde
+{
+    namespace types
+    {
+        namespace hid
+        {
+            struct string
+            {
+                hyde::hid::tick t;
+                std::string x;
+            };
+
+            template <typename T>
+            struct vec1
+            {
+                hyde::hid::tick t;
+                float treshold;
+                T x, xdt;
+
+                vec1( const T &t0 = T() ) : t(0),treshold(0.0f),x(t0),xdt(0) {}
+                vec1( const vec1 &v ) { operator=(v); }
+                vec1 &operator =( const vec1 &v ) { if( this != &v ) t = v.t, treshold = v.treshold, x = v.x, xdt = v.xdt; return *this; }
+                void set( const vec1 &v ) { xdt = v.x - x; x = v.x; }
+                const bool operator ==( const vec1 &v ) const { return std::abs( x - v.x ) < treshold; }
+                void import( const vec1 &v )
+                    { operator=( v ); };
+            };
+
+            template <typename T>
+            struct vec2
+            {
+                hyde::hid::tick t;
+                float treshold;
+                T x, y, xdt, ydt;
+
+                vec2( const T &t0 = T(), const T &t1 = T() ) : t(0),treshold(0.0f),x(t0),y(t1),xdt(0),ydt(0) {}
+                vec2( const vec2 &v ) { operator=(v); }
+                vec2 &operator =( const vec2 &v ) { if( this != &v ) t = v.t, treshold = v.treshold, x = v.x, y = v.y, xdt = v.xdt, ydt = v.ydt; return *this; }
+                void set( const vec2 &v ) { xdt = v.x - x, ydt = v.y - y; x = v.x, y = v.y; }
+                const bool operator ==( const vec2 &v ) const { return std::abs( x - v.x ) < treshold && std::abs( y - v.y ) < treshold; }
+                void import( const vec2 &v )
+                    { operator=( v ); };
+            };
+
+            template <typename T>
+            struct vec3
+            {
+                hyde::hid::tick t;
+                float treshold;
+                T x, y, z, xdt, ydt, zdt;
+
+                vec3( const T &t0 = T(), const T &t1 = T(), const T &t2 = T() ) : t(0),treshold(0.0f),x(t0),y(t1),z(t2),xdt(0),ydt(0),zdt(0) {}
+                vec3( const vec3 &v ) { operator=(v); }
+                vec3 &operator =( const vec3 &v ) { if( this != &v ) t = v.t, treshold = v.treshold, x = v.x, y = v.y, z = v.z, xdt = v.xdt, ydt = v.ydt, zdt = v.zdt; return *this; }
+                void set( const vec3 &v ) { xdt = v.x - x, ydt = v.y - y, zdt = v.z - z; x = v.x, y = v.y, z = v.z; }
+                const bool operator ==( const vec3 &v ) const { return std::abs( x - v.x ) < treshold && std::abs( y - v.y ) < treshold && std::abs( z - v.z ) < treshold; }
+                void import( const vec3 &v )
+                    { operator=( v ); };
+            };
+
+            // per-component access, used to split samples into separate arrays (see history_soa)
+
+            template <typename SAMPLE_TYPE>
+            struct traits;
+
+            template <typename T>
+            struct traits< vec1<T> >
+            {
+                typedef T value_type;
+                static const size_t dims = 1;
+                static T vec1<T>::*value( size_t i ) { static T vec1<T>::* const m[] = { &vec1<T>::x }; return m[i]; }
+                static T vec1<T>::*delta( size_t i ) { static T vec1<T>::* const m[] = { &vec1<T>::xdt }; return m[i]; }
+            };
+
+            template <typename T>
+            struct traits< vec2<T> >
+            {
+                typedef T value_type;
+                static const size_t dims = 2;
+                static T vec2<T>::*value( size_t i ) { static T vec2<T>::* const m[] = { &vec2<T>::x, &vec2<T>::y }; return m[i]; }
+                static T vec2<T>::*delta( size_t i ) { static T vec2<T>::* const m[] = { &vec2<T>::xdt, &vec2<T>::ydt }; return m[i]; }
+            };
+
+            template <typename T>
+            struct traits< vec3<T> >
+            {
+                typedef T value_type;
+                static const size_t dims = 3;
+                static T vec3<T>::*value( size_t i ) { static T vec3<T>::* const m[] = { &vec3<T>::x, &vec3<T>::y, &vec3<T>::z }; return m[i]; }
+                static T vec3<T>::*delta( size_t i ) { static T vec3<T>::* const m[] = { &vec3<T>::xdt, &vec3<T>::ydt, &vec3<T>::zdt }; return m[i]; }
+            };
+        }
+
+        namespace wip_hid
+        {
+            // normalized data [ -1, +1 ] for HIDs (human interface devices)
+
+            template <const int N, typename T = float>
+            struct vec
+            {
+                T elem[ N ];
+
+                vec()
+                    { for( size_t i = 0; i < N; ++i ) elem[ i ] = 0; }
+                vec( const vec<N,T> &v )
+                    { operator=( v.elem ); }
+                vec( const T *v )
+                    { operator=( v ); }
 
                 void operator =( const T *v )
                     { for( size_t i = 0; i < N; ++i ) elem[ i ] = v[ i ]; }
@@ -740,397 +1570,3234 @@ namespace hyde
         }
     }
 
-    typedef hyde::history< types::hid::vec1<float> > flag;
-    typedef hyde::history< types::hid::vec1<float> > key;
-    typedef hyde::history< types::hid::vec1<float> > button;
-    typedef hyde::history< types::hid::vec2<float> > coordinate;        //axis2d? xy?
-    typedef hyde::history< types::hid::vec3<float> > axis;              //axis3d? xyz?
-    typedef hyde::history< types::hid::     string > serializer;
+    template< typename SAMPLE_TYPE, const int N = 120 >
+    class history_soa : public SAMPLE_TYPE
+    {
+        // same ring of N samples than hyde::history, but stored as a struct-of-arrays:
+        //
+        // ts[]           t0 t1 ... tN-1
+        // values[0][]    x0 x1 ... xN-1
+        // values[1][]    y0 y1 ... yN-1
+        // deltas[0][]    xdt0 ... xdtN-1
+        // ...
+        //
+        // so time scans (find_t, duration) only touch timestamps and gesture predicates only
+        // touch timestamps and first component. treshold is kept once per history (inherited
+        // from SAMPLE_TYPE) rather than once per sample.
+        //
 
-    typedef std::vector<          flag > flags;
-    typedef std::vector<           key > keys;
-    typedef std::vector<        button > buttons;
-    typedef std::vector<    coordinate > coordinates;
-    typedef std::vector<          axis > axes;
-    typedef std::vector<    serializer > serializers;
-}
+        typedef types::hid::traits< SAMPLE_TYPE > traits;
+        typedef typename traits::value_type value_type;
 
+        std::array< hid::tick, N > ts;
+        std::array< std::array< value_type, N >, traits::dims > values, deltas;
+        size_t head;
 
+        size_t slot( size_t pos ) const
+        {
+            return ( head + pos ) % N;
+        }
 
-#ifdef _WIN32
+        public:
 
-#include <limits>
-#include <set>
+        history_soa() : head(0)
+        {
+            for( size_t d = 0; d < traits::dims; ++d )
+                values[d].fill( value_type() ), deltas[d].fill( value_type() );
 
-#include <cassert>
-#include <iostream>
+            clear();
+        }
 
-#include <map>
+        size_t size() const
+        {
+            return N;
+        }
 
-#include <cassert>
-#include <winsock2.h>
-#include <Windows.h>
-#include <mmsystem.h>                   // joystick
-#include <XInput.h>                     // gamepad360
+        void clear()
+        {
+            ts.fill( global_timer.now() );
+        }
 
-#pragma comment(lib, "winmm.lib")       // joystick
-#pragma comment(lib, "XInput.lib")      // gamepad360
-#pragma comment(lib, "user32.lib")      // GetAsyncKeyState [...]
+        // raw accessors
 
-#include "deps/manymouse/manymouse.h"
+        const hid::tick &t( size_t pos ) const
+        {
+            assert( pos < N );
+            return ts[ slot(pos) ];
+        }
 
-namespace hyde
-{
-    class sharing_policy
-    {
-        public:
+        const value_type &value( size_t pos, size_t dim = 0 ) const
+        {
+            assert( pos < N && dim < traits::dims );
+            return values[dim][ slot(pos) ];
+        }
 
-        template<typename T>
-        static T *get_master( T &controller, size_t id , bool is_creating )
+        const value_type &delta( size_t pos, size_t dim = 0 ) const
         {
-            // quick auto-creation map
-            struct tid
-            {
-                T *master;  //shared_ptr
-                size_t id, num_instances;
-                tid( size_t _id = 0 ) : master(0), id(_id), num_instances(0) {}
-                const bool operator <( const tid &t ) const { return id < t.id; }
-            };
+            assert( pos < N && dim < traits::dims );
+            return deltas[dim][ slot(pos) ];
+        }
+
+        // sample accessors (samples are gathered from arrays, hence returned by value)
 
-            static std::map<tid,tid> map;
+        SAMPLE_TYPE at( size_t pos ) const
+        {
+            assert( pos < N );
 
-            tid &ref_id = ( map[tid(id)] = map[tid(id)] );
+            SAMPLE_TYPE sample;
+            sample.t = ts[ slot(pos) ];
+            sample.treshold = this->treshold;
 
-            if( is_creating )
-            {
-                if( ref_id.num_instances + 1 <= 1 )
-                {
-                    ref_id.master = &controller;
-                    ++ref_id.num_instances;
-                }
-                //else //throw hyde::string( "error: device id #\1 already in use! (seen at \2 controller)", id, controller.typeof );
-            }
-            else
+            for( size_t d = 0; d < traits::dims; ++d )
             {
-                --ref_id.num_instances;
+                sample.*traits::value(d) = values[d][ slot(pos) ];
+                sample.*traits::delta(d) = deltas[d][ slot(pos) ];
             }
 
-            return ref_id.master;
+            return sample;
         }
-    };
 
-    namespace windows_wip
-    {
+        SAMPLE_TYPE newest() const
+        {
+            return at(0);
+        }
 
-        class joystick
+        // timestamp and first component of a sample, as read by hyde::pattern<>
+
+        struct lane
         {
-            UINT joy_id;
+            hid::tick t;
+            value_type x;
+        };
 
-            public:
+        class const_iterator
+        {
+            const history_soa *h;
+            size_t pos;
 
-            hyde::flag is_ready;
-            hyde::coordinate xy;
-            hyde::buttons buttons;
+            public:
 
-            // http://www.gnu-darwin.org/www001/src/ports/graphics/gephex/work/gephex-0.4.3/util/src/libjoystick/win32joystickdriver.cpp
-            // http://www.gnu-darwin.org/www001/src/ports/graphics/gephex/work/gephex-0.4.3/util/src/libjoystick/
+            const_iterator( const history_soa *_h, size_t _pos ) : h(_h), pos(_pos)
+            {}
 
-            joystick( unsigned id )
+            lane operator []( size_t n ) const
             {
-                assert( id <  2 && "invalid joystick id" ); /* // nt [0.. 1]
-                assert( id < 16 && "invalid joystick id" ); */ // xp [0..15]
+                lane l = { h->t( pos + n ), h->value( pos + n ) };
+                return l;
+            }
+        };
 
-                joy_id = JOYSTICKID1 + id;
+        const_iterator begin() const
+        {
+            return const_iterator( this, 0 );
+        }
 
-                // calibrate
-                // WinExec("control joy.cpl", SW_NORMAL);
+        hid::tick newest_t() const
+        {
+            return t(0);
+        }
 
-                /*
-                MMRESULT mr;
-                JOYCAPS jc;
+        bool aged() const
+        {
+            return false;
+        }
 
-                mr = joyGetDevCaps(handle, &jc, sizeof(jc));
+        const double duration() const
+        {
+            return hid::dt::to_seconds( t(1) - t(N-1) );
+        }
 
-                if (mr != JOYERR_NOERROR)
-                {
-                    throw std::runtime_error("Could not get caps for joystick");
-                }
-
-                m_num_axes      = jc.wNumAxes;
-                m_num_buttons   = jc.wNumButtons;
-                m_state.axes    = std::vector<int>(m_num_axes, 0);
-                m_state.buttons = std::vector<bool>(m_num_buttons, false);
-                */
-            }
-
-            void clear()
-            {
-                is_ready.clear();
-                xy.clear();
+        size_t find_dt( const double &dt01 ) const
+        {
+            // 0 = newest ... 1 = oldest
 
-                for( auto &it : buttons )
-                    it.clear();
-            }
+            size_t dtpos = size_t( dt01 * N );
 
-            void update()
-            {
-                if( !GetFocus() )
-                {
-                    if( GetForegroundWindow() != GetConsoleWindow() )
-                    {
-                        clear();
-                        return;
-                    }
-                }
+            return dtpos >= N ? N - 1 : dtpos;
+        }
+        size_t find_t( const double &seconds_ago ) const
+        {
+            if( seconds_ago <= 0 )
+                return 0;
 
-                //typedef struct joyinfoex_tag {
-                //    DWORD dwSize;                /* size of structure */
-                //    DWORD dwFlags;               /* flags to indicate what to return */
-                //    DWORD dwXpos;                /* x position */
-                //    DWORD dwYpos;                /* y position */
-                //    DWORD dwZpos;                /* z position */ <-- throttle
-                //    DWORD dwRpos;                /* rudder/4th axis position */ <-- pedals
-                //    DWORD dwUpos;                /* 5th axis position */
-                //    DWORD dwVpos;                /* 6th axis position */
-                //    DWORD dwButtons;             /* button states */
-                //    DWORD dwButtonNumber;        /* current button number pressed */
-                //    DWORD dwPOV;                 /* point of view state */
-                //    DWORD dwReserved1;           /* reserved for communication between winmm & driver */
-                //    DWORD dwReserved2;           /* reserved for future expansion */
-                //} JOYINFOEX, *PJOYINFOEX, NEAR *NPJOYINFOEX, FAR *LPJOYINFOEX;
+            if( seconds_ago >= duration() )
+                return N - 1;
 
-                JOYCAPS joyCaps;
-                joyGetDevCaps(joy_id, &joyCaps, sizeof(joyCaps));
-                BOOL has_throttle = (joyCaps.wCaps & JOYCAPS_HASZ);
+            return find_t( 0, t(0) - hid::dt::to_ticks( seconds_ago ) );
+        }
+        std::pair< size_t, size_t > find_t_range( const double &from_t, const double &to_t ) const
+        {
+            size_t from = find_t( from_t );
 
-                JOYINFOEX joyInfoEx;
-                ZeroMemory(&joyInfoEx, sizeof(joyInfoEx));
+            if( to_t <= from_t )
+                return std::make_pair( from, from );
 
-                joyInfoEx.dwSize = sizeof(joyInfoEx);
-                joyInfoEx.dwFlags = JOY_RETURNALL | JOY_RETURNCENTERED | JOY_USEDEADZONE | (has_throttle ? JOY_RETURNZ : 0);
+            if( to_t >= duration() )
+                return std::make_pair( from, size_t(N - 1) );
 
-                BOOL is_present = (joyGetPosEx(joy_id, &joyInfoEx) == JOYERR_NOERROR);
-                is_ready.set( is_present ? 1.f : 0.f );
+            return std::make_pair( from, find_t( from, t(0) - hid::dt::to_ticks( to_t ) ) );
+        }
 
-                if( is_present )
-                {
-                    // vec6 !
-                    /*
-                    axes[0] = joyInfoEx.dwXpos;
-                    axes[1] = joyInfoEx.dwYpos;
-                    if (m_num_axes > 2)
-                        m_state.axes[2] = joyInfoEx.dwZpos; // throttle? sure?
-                    if (m_num_axes > 3)
-                        m_state.axes[3] = joyInfoEx.dwRpos;
-                    if (m_num_axes > 4)
-                        m_state.axes[4] = joyInfoEx.dwUpos;
-                    if (m_num_axes > 5)
-                        m_state.axes[5] = joyInfoEx.dwVpos;
-                    */
+        SAMPLE_TYPE then_dt( const double &dt ) const
+        {
+            return at( find_dt( dt ) );
+        }
+        SAMPLE_TYPE then_t( const double &seconds_ago_lapse ) const
+        {
+            return at( find_t( seconds_ago_lapse ) );
+        }
 
-                    size_t num_buttons = buttons.size();
-                    for( size_t i = 0; i < num_buttons; ++i )
-                        buttons[i].set( (joyInfoEx.dwButtons & (JOY_BUTTON1+i) ) ? 1 : 0 );
-                }
-            }
-        };
-    }
+        private:
 
-    namespace windows
-    {
-        class gamepad
+        size_t find_t( size_t first, const hid::tick &time_target ) const
         {
-            private:
+            // binary search over timestamps only (newest first)
 
-                XINPUT_STATE state;
-                DWORD id;
+            size_t lo = first, hi = N;
 
-            public:
+            while( lo < hi )
+            {
+                size_t mid = lo + ( hi - lo ) / 2;
 
-                // pad pieces
+                if( ts[ slot(mid) ] > time_target )
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
 
-                // 10x buttons,   1d data input (action)
-                //  2x triggers,  1d data input (action)
-                hyde::button
-                    a, b, x, y,
-                    back, start,
-                    lb, rb,
-                    lthumb, rthumb,
-                    ltrigger, rtrigger;
+            return lo < N ? lo : N - 1;
+        }
 
-                //  2x axis,      2d data input (spatial)
-                //  1x gamepad,   2d data input (spatial)
-                hyde::coordinate
-                    pad,
-                    lpad, rpad;
+        void set( const SAMPLE_TYPE &new_sample )
+        {
+            set( new_sample, global_timer.now() );
+        }
 
-                //  1x mic,       1d data output (mono audio)
-                hyde::button
-                    mic;
+        void notify( const SAMPLE_TYPE &sample, const hid::tick &now )
+        {
+            float values[ traits::dims ];
+            for( size_t d = 0; d < traits::dims; ++d )
+                values[d] = float( sample.*traits::value(d) );
 
-                //  1x earphones, 2d data output (stereo audio)
-                hyde::coordinates
-                    earphones;
+            global_timer.notify( this, now, values, traits::dims );
+        }
 
-                // 47x keys,      1d data input (text)
-                hyde::keys
-                    keymap;
+        void set( const SAMPLE_TYPE &new_sample, hid::tick now )
+        {
+            size_t front = head;
 
-                // 2x rumble,     1d data output (rumble haptic)
-                hyde::buttons rumble;
+            // strict, as SAMPLE_TYPE::operator== in hyde::history::set()
+            bool same = true, changed = false;
+            for( size_t d = 0; d < traits::dims; ++d )
+            {
+                value_type delta = std::abs( values[d][front] - new_sample.*traits::value(d) );
+                same = same && delta < this->treshold;
+                changed = changed || delta > this->treshold;
+            }
 
-                hyde::flag
-                    is_ready;   // ~? is_present, is_plugged, is_connected
+            if( now < ts[ front ] )
+                now = ts[ front ];
 
-                gamepad *master;
+            notify( new_sample, now );
 
-            gamepad( const unsigned &_id ) :
-                id(_id),
-                keymap(47),
-                rumble(2),
-                typeof( "hyde::windows::gamepad" )
+            ts[ front ] = now;
+
+            if( !same )
             {
+                head = ( head + N - 1 ) % N;
 
-                if( id >= max_devices )
+                for( size_t d = 0; d < traits::dims; ++d )
                 {
-                    std::cerr << "error: device id #" << id << " invalid! (seen at " << typeof << " controller)" << std::endl;
-                    assert( false );
-                    return;
+                    values[d][head] = new_sample.*traits::value(d);
+                    deltas[d][head] = values[d][head] - values[d][front];
                 }
 
-                master = sharing_policy::get_master( *this, id, true );
-
-                if( master == this )
-                    set_rumble( 0.f, 0.f );
+                ts[ head ] = now;
 
-//                ltrigger.newest().deadzone = 0.1f;
-//                rtrigger.newest().deadzone = 0.1f;
+                if( changed )
+                    global_timer.touch( this );
             }
 
-            ~gamepad()
-            {
-                if( master == this )
-                    set_rumble( 0.f, 0.f );
+            this->import( newest() );
+        }
 
-                // check & decrement instance counter
-                master = sharing_policy::get_master( *this, id, false );
-            }
+        public:
 
-            const char *const typeof;
-            static const size_t max_devices = 4;
+        // sugars{
 
-            protected:
+        template <typename T>
+        void set( const T &t0 )
+        {
+            set( SAMPLE_TYPE(t0) );
+        }
 
-            XINPUT_GAMEPAD get_state()
-            {
-                ZeroMemory(&state, sizeof(XINPUT_STATE));
+        template <typename T>
+        void set( const T &t0, const T &t1 )
+        {
+            set( SAMPLE_TYPE(t0,t1) );
+        }
 
-                XInputGetState(id, &state);
+        template <typename T>
+        void set( const T &t0, const T &t1, const T &t2 )
+        {
+            set( SAMPLE_TYPE(t0,t1,t2) );
+        }
 
-                return state.Gamepad;
-            }
+        // same, stamped at tick 't' instead of global_timer.now() (ie, when the event was read)
 
-            void set_rumble( const float &left01, const float &right01 )
-            {
-                assert( left01 >= 0.f && left01 <= 1.f );
-                assert( right01 >= 0.f && right01 <= 1.f );
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0 )
+        {
+            set( SAMPLE_TYPE(t0), t );
+        }
 
-                //if(!is_ready()) return;
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0, const T &t1 )
+        {
+            set( SAMPLE_TYPE(t0,t1), t );
+        }
 
-                XINPUT_VIBRATION vibration_state;
-                ZeroMemory( &vibration_state, sizeof( XINPUT_VIBRATION ) );
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0, const T &t1, const T &t2 )
+        {
+            set( SAMPLE_TYPE(t0,t1,t2), t );
+        }
 
-                vibration_state.wLeftMotorSpeed  = DWORD(  left01 * 65535.f );
-                vibration_state.wRightMotorSpeed = DWORD( right01 * 65535.f );
+        //}
 
-                XInputSetState( id, &vibration_state );
+        // pattern matching {
+
+            // same hyde::patterns than hyde::history. patterns only read timestamps and first
+            // component, so lanes are gathered from ts[] and values[0][] on the fly.
+            template< typename PATTERN >
+            bool match() const
+            {
+                return PATTERN::match( *this );
             }
 
-            public:
+            template< typename PATTERN >
+            bool match( float interval_t ) const
+            {
+                hid::tick shortest = PATTERN::window::shortest(), longest = PATTERN::window::longest();
+                PATTERN::window::adjust( hid::dt::to_ticks( interval_t ), shortest, longest );
+                return PATTERN::match( *this, shortest, longest );
+            }
 
-            void clear()
+            // idle: low [then] -> low [now]
+            bool idle() const
             {
-                a.clear();
-                b.clear();
-                x.clear();
-                y.clear();
-                back.clear();
-                start.clear();
-                lb.clear();
-                rb.clear();
-                lthumb.clear();
-                rthumb.clear();
-                ltrigger.clear();
-                rtrigger.clear();
-                pad.clear();
-                lpad.clear();
-                rpad.clear();
-                mic.clear();
-                is_ready.clear();
+                return match< patterns::idle >();
+            }
+            bool idle( float interval_t ) const
+            {
+                return match< patterns::idle >( interval_t );
+            }
 
-                for( auto &it : earphones )
-                    it.clear();
+            // trigger: [then] low -> high [now]
+            bool trigger() const
+            {
+                return match< patterns::trigger >();
+            }
+            bool trigger( float interval_t ) const
+            {
+                return match< patterns::trigger >( interval_t );
+            }
 
-                for( auto &it : keymap )
-                    it.clear();
+            // hold: high [now]
+            bool hold() const
+            {
+                return match< patterns::hold >();
+            }
 
-                for( auto &it : rumble )
-                    it.clear();
+            // release: [then] high -> low [now]
+            bool release() const
+            {
+                return match< patterns::release >();
+            }
+            bool release( float interval_t ) const
+            {
+                return match< patterns::release >( interval_t );
             }
 
-            void update()
+            // click: [then] low -> high -> low [now]
+            bool click( float interval_t = 0.500f ) const
             {
-                if( master != this )
-                {
-                    a = master->a;
-                    b = master->b;
-                    x = master->x;
-                    y = master->y;
-                    back = master->back;
-                    start = master->start;
-                    lb = master->lb;
-                    rb = master->rb;
-                    lthumb = master->lthumb;
-                    rthumb = master->rthumb;
-                    ltrigger = master->ltrigger;
-                    rtrigger = master->rtrigger;
-                    pad = master->pad;
-                    lpad = master->lpad;
-                    rpad = master->rpad;
-                    mic = master->mic;
-                    earphones = master->earphones;
-                    keymap = master->keymap;
-                    rumble = master->rumble;
-                    is_ready = master->is_ready;
+                return match< patterns::click >( interval_t );
+            }
 
-                    return;
-                }
+            // dclick: [then] low -> high -> low -> high -> low [now]
+            bool dclick( float interval_t = 0.500f ) const
+            {
+                return match< patterns::dclick >( interval_t );
+            }
 
-                if( !GetFocus() )
-                {
-                    if( GetForegroundWindow() != GetConsoleWindow() )
-                    {
-                        clear();
-                        return;
-                    }
-                }
+            // tclick: [then] low -> high -> low -> high -> low -> high -> low [now]
+            bool tclick( float interval_t = 0.750f ) const
+            {
+                return match< patterns::tclick >( interval_t );
+            }
 
-                ZeroMemory(&state, sizeof(XINPUT_STATE));
-                bool is_present = ( XInputGetState( id, &state ) == ERROR_SUCCESS );
+            // longpress: [then] low -> high [now], high for 0.5 seconds at least
+            bool longpress() const
+            {
+                return match< patterns::longpress >();
+            }
 
-                is_ready.set( is_present );
+        // }
+    };
 
-                if( !is_present )
-                    return;
+    // random access iterator over a power-of-two ring of runtime capacity, newest first
 
-                // read device
-                XINPUT_GAMEPAD state = get_state();
+    template< typename SAMPLE_TYPE >
+    class history_ring_iterator
+    {
+        const SAMPLE_TYPE *ring;
+        size_t mask, head;
+        std::ptrdiff_t pos;
 
-                // process inputs : buttons
+        public:
 
-                     a.set( state.wButtons &              XINPUT_GAMEPAD_A ? 1.0f : 0.f );
-                     b.set( state.wButtons &              XINPUT_GAMEPAD_B ? 1.0f : 0.f );
-                     x.set( state.wButtons &              XINPUT_GAMEPAD_X ? 1.0f : 0.f );
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef SAMPLE_TYPE value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const SAMPLE_TYPE *pointer;
+        typedef const SAMPLE_TYPE &reference;
+
+        history_ring_iterator( const SAMPLE_TYPE *_ring = 0, size_t _mask = 0, size_t _head = 0, std::ptrdiff_t _pos = 0 ) : ring(_ring), mask(_mask), head(_head), pos(_pos) {}
+
+        reference operator *() const { return ring[ ( head + pos ) & mask ]; }
+        pointer operator ->() const { return &operator*(); }
+        reference operator []( difference_type n ) const { return *( *this + n ); }
+
+        history_ring_iterator &operator ++() { ++pos; return *this; }
+        history_ring_iterator &operator --() { --pos; return *this; }
+        history_ring_iterator operator ++( int ) { history_ring_iterator it( *this ); ++pos; return it; }
+        history_ring_iterator operator --( int ) { history_ring_iterator it( *this ); --pos; return it; }
+        history_ring_iterator &operator +=( difference_type n ) { pos += n; return *this; }
+        history_ring_iterator &operator -=( difference_type n ) { pos -= n; return *this; }
+        history_ring_iterator operator +( difference_type n ) const { return history_ring_iterator( ring, mask, head, pos + n ); }
+        history_ring_iterator operator -( difference_type n ) const { return history_ring_iterator( ring, mask, head, pos - n ); }
+        difference_type operator -( const history_ring_iterator &it ) const { return pos - it.pos; }
+
+        bool operator ==( const history_ring_iterator &it ) const { return pos == it.pos; }
+        bool operator !=( const history_ring_iterator &it ) const { return pos != it.pos; }
+        bool operator  <( const history_ring_iterator &it ) const { return pos  < it.pos; }
+        bool operator  >( const history_ring_iterator &it ) const { return pos  > it.pos; }
+        bool operator <=( const history_ring_iterator &it ) const { return pos <= it.pos; }
+        bool operator >=( const history_ring_iterator &it ) const { return pos >= it.pos; }
+    };
+
+    template< typename SAMPLE_TYPE, long long MS = 2000, size_t MAX_SAMPLES = 4096 >
+    class history_timed : public SAMPLE_TYPE, public history_queries< history_timed< SAMPLE_TYPE, MS, MAX_SAMPLES >, SAMPLE_TYPE, history_ring_iterator< SAMPLE_TYPE > >
+    {
+        // same as hyde::history, but bounded by time rather than by sample count: keeps the
+        // last MS milliseconds, whatever the polling rate of the device.
+        //
+        // (t0,sample0) (t1,sample1) ... (tK-1,sampleK-1)
+        // newest...oldest, tK-2 > t0 - MS >= tK-1
+        //
+        // so the oldest sample is the one in effect MS milliseconds ago, and find_t()/then_t()
+        // answer the same for a 1000 Hz mouse and a 60 Hz pad within that window.
+        //
+        // storage is a power-of-two ring that doubles when full, up to MAX_SAMPLES (the hard
+        // memory ceiling: MAX_SAMPLES * sizeof(SAMPLE_TYPE) bytes). at the ceiling, the oldest
+        // sample is recycled even if it is still within the window. samples are evicted by
+        // timestamp on every set(), but at least min_samples are kept, so every predefined
+        // pattern (up to tclick) has enough samples to look at.
+        //
+
+        std::vector< SAMPLE_TYPE > container;
+        size_t head, count;
+
+        // lazy aging, as in hyde::history::age_from()
+        const hid::polls *polled;
+
+        public:
+
+        typedef history_ring_iterator< SAMPLE_TYPE > const_iterator;
+
+        static const size_t min_samples = 8;
+
+        history_timed() : container( min_samples ), head(0), count(0), polled(0)
+        {
+            static_assert( MAX_SAMPLES >= min_samples && !( MAX_SAMPLES & ( MAX_SAMPLES - 1 ) ), "MAX_SAMPLES must be a power of two, >= min_samples" );
+
+            clear();
+        }
+
+        void age_from( const hid::polls *device_polls )
+        {
+            polled = device_polls;
+        }
+
+        hid::tick newest_t() const
+        {
+            const hid::tick &t = at(0).t;
+            return polled && polled->last > t ? polled->last : t;
+        }
+
+        // see hyde::history::aged()
+        bool aged() const
+        {
+            return polled && at(0).t <= polled->previous;
+        }
+
+        size_t size() const
+        {
+            return count;
+        }
+
+        size_t capacity() const
+        {
+            return container.size();
+        }
+
+        static double window()
+        {
+            return MS / 1000.0;
+        }
+
+        void clear()
+        {
+            clear( global_timer.now() );
+        }
+
+        void clear( const hid::tick &now )
+        {
+            // back to min_samples copies of current value, all stamped now (as hyde::history does)
+            SAMPLE_TYPE current = count ? at(0) : SAMPLE_TYPE();
+
+            container.assign( min_samples, current );
+            container.shrink_to_fit();
+            head = 0;
+            count = min_samples;
+
+            for( auto &it : container )
+                it.t = now;
+        }
+
+        // forget every sample: whole history becomes 'sample', stamped at t (ie, when seeking a replay)
+        void reset( const SAMPLE_TYPE &sample, const hid::tick &t )
+        {
+            SAMPLE_TYPE fill( sample );
+            fill.treshold = at(0).treshold;
+            fill.t = t;
+
+            container.assign( min_samples, fill );
+            head = 0;
+            count = min_samples;
+
+            this->import( this->newest() );
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator( container.data(), container.size() - 1, head, 0 );
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator( container.data(), container.size() - 1, head, count );
+        }
+
+        const SAMPLE_TYPE &at( size_t pos ) const
+        {
+            assert( pos < count );
+            return container[ ( head + pos ) & ( container.size() - 1 ) ];
+        }
+
+        const double duration() const
+        {
+            return count < 2 ? 0 : hid::dt::to_seconds( at(0).t - at(count-1).t );
+        }
+
+        private:
+
+        void notify( const SAMPLE_TYPE &sample, const hid::tick &now )
+        {
+            typedef types::hid::traits< SAMPLE_TYPE > traits;
+
+            float values[ traits::dims ];
+            for( size_t d = 0; d < traits::dims; ++d )
+                values[d] = float( sample.*traits::value(d) );
+
+            global_timer.notify( this, now, values, traits::dims );
+        }
+
+        void grow()
+        {
+            // unroll the ring into a buffer twice as big, newest first
+            std::vector< SAMPLE_TYPE > bigger( container.size() * 2 );
+
+            for( size_t i = 0; i < count; ++i )
+                bigger[i] = at(i);
+
+            container.swap( bigger );
+            head = 0;
+        }
+
+        void evict( const hid::tick &now )
+        {
+            // drop oldest while the next one is already old enough to answer for the window start
+            hid::tick cutoff = now - MS * 1000000LL;
+
+            while( count > min_samples && at( count - 2 ).t <= cutoff )
+                --count;
+        }
+
+        void set( const SAMPLE_TYPE &new_sample )
+        {
+            set( new_sample, global_timer.now() );
+        }
+
+        void set( const SAMPLE_TYPE &new_sample, hid::tick now )
+        {
+            // samples stay sorted (newest first) even if events arrive stamped out of order
+            if( now < this->newest().t )
+                now = this->newest().t;
+
+            notify( new_sample, now );
+
+            // lazily aged, as in hyde::history::set()
+            if( polled && same_sample( this->newest(), new_sample ) )
+            {
+                evict( now );
+                return;
+            }
+
+            if( new_sample == this->newest() )   // update timestamp if value same than previous (~rle)
+            {
+                container[ head ].t = now;
+            }
+            else
+            {
+                container[ head ].t = now;
+
+                if( count == container.size() && container.size() < MAX_SAMPLES )
+                    grow();
+
+                // new front keeps treshold and other members from current front
+                size_t front = head;
+                head = ( head + container.size() - 1 ) & ( container.size() - 1 );
+
+                container[ head ] = container[ front ];
+                container[ head ].set( new_sample );
+                container[ head ].t = now;
+
+                if( count < container.size() )
+                    ++count;
+
+                if( !same_sample( container[ front ], new_sample ) )
+                    global_timer.touch( this );
+            }
+
+            evict( now );
+
+            this->import( this->newest() );
+        }
+
+        public:
+
+        // sugars{
+
+        template <typename T>
+        void set( const T &t0 )
+        {
+            set( SAMPLE_TYPE(t0) );
+        }
+
+        template <typename T>
+        void set( const T &t0, const T &t1 )
+        {
+            set( SAMPLE_TYPE(t0,t1) );
+        }
+
+        template <typename T>
+        void set( const T &t0, const T &t1, const T &t2 )
+        {
+            set( SAMPLE_TYPE(t0,t1,t2) );
+        }
+
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0 )
+        {
+            set( SAMPLE_TYPE(t0), t );
+        }
+
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0, const T &t1 )
+        {
+            set( SAMPLE_TYPE(t0,t1), t );
+        }
+
+        template <typename T>
+        void set_at( const hid::tick &t, const T &t0, const T &t1, const T &t2 )
+        {
+            set( SAMPLE_TYPE(t0,t1,t2), t );
+        }
+
+        //}
+    };
+
+    typedef hyde::history< types::hid::vec1<float> > flag;
+    typedef hyde::history< types::hid::vec1<float> > key;
+    typedef hyde::history< types::hid::vec1<float> > button;
+    typedef hyde::history< types::hid::vec2<float> > coordinate;        //axis2d? xy?
+    typedef hyde::history< types::hid::vec3<float> > axis;              //axis3d? xyz?
+    typedef hyde::history< types::hid::     string > serializer;
+
+    // time bounded flavours (last 2 seconds, see hyde::history_timed)
+    typedef hyde::history_timed< types::hid::vec1<float> > timed_button;
+    typedef hyde::history_timed< types::hid::vec2<float> > timed_coordinate;
+    typedef hyde::history_timed< types::hid::vec3<float> > timed_axis;
+
+    typedef std::vector<          flag > flags;
+    typedef std::vector<           key > keys;
+    typedef std::vector<        button > buttons;
+    typedef std::vector<    coordinate > coordinates;
+    typedef std::vector<          axis > axes;
+    typedef std::vector<    serializer > serializers;
+}
+
+
+namespace hyde
+{
+    // packed on/off state of 256 keys, 1 bit per key. keyboards keep the previous poll as
+    // keybits and diff it word-wide against the new poll, so only flipped keys get set().
+
+    class keybits
+    {
+        std::array< std::uint64_t, 4 > words;
+
+        public:
+
+        static const size_t capacity = 256;
+
+        keybits()
+        {
+            words.fill( 0 );
+        }
+
+        void set( size_t key, bool on = true )
+        {
+            assert( key < capacity );
+            std::uint64_t bit = std::uint64_t(1) << ( key & 63 );
+            words[ key >> 6 ] = on ? words[ key >> 6 ] | bit : words[ key >> 6 ] & ~bit;
+        }
+
+        bool test( size_t key ) const
+        {
+            assert( key < capacity );
+            return ( words[ key >> 6 ] >> ( key & 63 ) ) & 1;
+        }
+
+        const std::uint64_t &word( size_t i ) const
+        {
+            return words[ i ];
+        }
+
+        std::uint64_t &word( size_t i )
+        {
+            return words[ i ];
+        }
+
+        bool any() const
+        {
+            return ( words[0] | words[1] | words[2] | words[3] ) != 0;
+        }
+
+        size_t count() const
+        {
+            return popcount( words[0] ) + popcount( words[1] ) + popcount( words[2] ) + popcount( words[3] );
+        }
+
+        static keybits all()
+        {
+            keybits out;
+            out.words.fill( ~std::uint64_t(0) );
+            return out;
+        }
+
+        keybits operator ^( const keybits &other ) const
+        {
+            keybits out;
+            for( size_t i = 0; i < 4; ++i )
+                out.words[i] = words[i] ^ other.words[i];
+            return out;
+        }
+
+        keybits operator &( const keybits &other ) const
+        {
+            keybits out;
+            for( size_t i = 0; i < 4; ++i )
+                out.words[i] = words[i] & other.words[i];
+            return out;
+        }
+
+        keybits operator |( const keybits &other ) const
+        {
+            keybits out;
+            for( size_t i = 0; i < 4; ++i )
+                out.words[i] = words[i] | other.words[i];
+            return out;
+        }
+
+        keybits operator ~() const
+        {
+            keybits out;
+            for( size_t i = 0; i < 4; ++i )
+                out.words[i] = ~words[i];
+            return out;
+        }
+
+        bool operator ==( const keybits &other ) const
+        {
+            return words == other.words;
+        }
+
+        bool operator !=( const keybits &other ) const
+        {
+            return words != other.words;
+        }
+
+        // call fn( key ) for every key set, in ascending order
+        template< typename FN >
+        void for_each( FN fn ) const
+        {
+            for( size_t i = 0; i < 4; ++i )
+                for( std::uint64_t w = words[i]; w; w &= w - 1 )
+                    fn( i * 64 + ctz( w ) );
+        }
+
+        static size_t popcount( std::uint64_t w )
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            return size_t( __popcnt64( w ) );
+#elif defined(__GNUC__)
+            return size_t( __builtin_popcountll( w ) );
+#else
+            size_t n = 0;
+            for( ; w; w &= w - 1 ) ++n;
+            return n;
+#endif
+        }
+
+        static size_t ctz( std::uint64_t w )
+        {
+            assert( w );
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanForward64( &index, w );
+            return size_t( index );
+#elif defined(__GNUC__)
+            return size_t( __builtin_ctzll( w ) );
+#else
+            size_t n = 0;
+            for( ; !( w & 1 ); w >>= 1 ) ++n;
+            return n;
+#endif
+        }
+    };
+}
+
+namespace hyde
+{
+    // bulk key queries: hold/trigger/release/idle for a whole keymap at once, as keybits.
+    //
+    // a keyplane keeps two packed planes of the 256 keys: state at last poll, and keys that
+    // flipped during last poll. trigger/release/idle are word-wide ops on them, so they hold for
+    // exactly one poll, as the per-key predicates. with a single flip per poll, the edges plane
+    // is just current ^ previous, so trigger is current & ~previous and release ~current & previous;
+    // keys flipped back and forth within a poll (ie, a tap shorter than a poll) are kept as well.
+    //
+    // it also keeps the tick each key last flipped at. recent() compares those 256 ticks against
+    // a single cutoff, done 4 (avx2) or 2 (sse2) keys per instruction, for the optional intervals.
+    //
+    // results match the per-key predicates of a keymap that ages from polls(), ie:
+    //   keystate.trigger().test( k ) == keymap[ k ].trigger()
+
+    class keyplane
+    {
+        keybits current;
+
+        // keys flipped during last poll, and during the poll in progress
+        keybits edges, pending;
+
+        std::array< hid::tick, keybits::capacity > flipped;
+        hid::polls polled;
+
+        public:
+
+        keyplane()
+        {
+            reset( 0 );
+        }
+
+        // forget flips: every key is considered flipped at 'now' (see history::clear())
+        void reset( const hid::tick &now )
+        {
+            edges = pending = keybits();
+
+            flipped.fill( now );
+            polled = hid::polls( now );
+        }
+
+        // store an event read during the poll in progress and return the keys that flipped
+        keybits set( const keybits &now, const hid::tick &t )
+        {
+            keybits changed = now ^ current;
+
+            changed.for_each( [&]( size_t key ) {
+                flipped[ key ] = t;
+            } );
+
+            current = now;
+            pending = pending | changed;
+
+            return changed;
+        }
+
+        // store a new poll and return the keys that flipped
+        keybits update( const keybits &now, const hid::tick &t )
+        {
+            keybits changed = set( now, t );
+
+            edges = pending;
+            pending = keybits();
+
+            polled.advance( t );
+
+            return changed;
+        }
+
+        const keybits &state() const
+        {
+            return current;
+        }
+
+        const hid::tick &last_poll() const
+        {
+            return polled.last;
+        }
+
+        // ticks keymap histories age from (see history::age_from())
+        const hid::polls &polls() const
+        {
+            return polled;
+        }
+
+        // keys that flipped within interval_t seconds before last poll
+        keybits recent( float interval_t ) const
+        {
+            // flipped >= cutoff <=> sign bit of ( flipped - cutoff ) is clear
+            const hid::tick cutoff = polled.last - hid::dt::to_ticks( interval_t );
+
+            keybits out;
+
+            for( size_t w = 0; w < 4; ++w )
+            {
+                const hid::tick *ticks = &flipped[ w * 64 ];
+                std::uint64_t stale = 0;
+#if defined(HYDE_SIMD_AVX2)
+                const __m256i c = _mm256_set1_epi64x( cutoff );
+                for( size_t i = 0; i < 64; i += 4 )
+                {
+                    __m256i d = _mm256_sub_epi64( _mm256_loadu_si256( (const __m256i *)( ticks + i ) ), c );
+                    stale |= std::uint64_t( _mm256_movemask_pd( _mm256_castsi256_pd( d ) ) ) << i;
+                }
+#elif defined(HYDE_SIMD_SSE2)
+                const __m128i c = _mm_set1_epi64x( cutoff );
+                for( size_t i = 0; i < 64; i += 2 )
+                {
+                    __m128i d = _mm_sub_epi64( _mm_loadu_si128( (const __m128i *)( ticks + i ) ), c );
+                    stale |= std::uint64_t( _mm_movemask_pd( _mm_castsi128_pd( d ) ) ) << i;
+                }
+#else
+                for( size_t i = 0; i < 64; ++i )
+                    stale |= std::uint64_t( ticks[i] - cutoff < 0 ) << i;
+#endif
+                out.word( w ) = ~stale;
+            }
+
+            return out;
+        }
+
+        // hold: high [now]
+        keybits hold( const keybits &keys = keybits::all() ) const
+        {
+            return current & keys;
+        }
+
+        // trigger: [then] low -> high [now]
+        keybits trigger( const keybits &keys = keybits::all() ) const
+        {
+            return current & edges & keys;
+        }
+
+        // same, pressed within interval_t seconds before last poll (as button::trigger( interval_t ))
+        keybits trigger( const keybits &keys, float interval_t ) const
+        {
+            return current & edges & recent( interval_t ) & keys;
+        }
+
+        // release: [then] high -> low [now]
+        keybits release( const keybits &keys = keybits::all() ) const
+        {
+            return ~current & edges & keys;
+        }
+
+        // same, released within interval_t seconds before last poll
+        keybits release( const keybits &keys, float interval_t ) const
+        {
+            return ~current & edges & recent( interval_t ) & keys;
+        }
+
+        // idle: low [then] -> low [now]
+        keybits idle( const keybits &keys = keybits::all() ) const
+        {
+            return ~( current | edges ) & keys;
+        }
+    };
+}
+
+namespace hyde
+{
+    // hub: owns a set of devices and polls all of them in one pass, under a single
+    // frame-clock timestamp. after update(), changed() lists every control whose value
+    // changed during that pass (beyond its treshold), so consumers can skip idle controls.
+    //
+    // hyde::hub hub;
+    // auto &kb = hub.add< hyde::windows::keyboard >( 0 );
+    // hub.update();
+    // if( hub.changed( kb.space ) ) ...
+    //
+    // hub.set_clock( &clock ) makes add() and update() read a hid::virtual_clock instead.
+    //
+    // a hub, like any device, is updated and read by one thread at a time (usually, the game
+    // loop). frames are per thread, so other threads may run hubs of their own meanwhile.
+
+    class hub
+    {
+        struct device
+        {
+            virtual ~device() {}
+            virtual void update() = 0;
+        };
+
+        template< typename DEVICE >
+        struct model : public device
+        {
+            DEVICE instance;
+
+            template< typename... ARGS >
+            model( ARGS &&... args ) : instance( std::forward< ARGS >( args )... )
+            {}
+
+            void update()
+            {
+                instance.update();
+            }
+        };
+
+        std::vector< std::unique_ptr< device > > devices;
+        std::vector< const void * > changes;
+        hid::virtual_clock *clock;
+
+        public:
+
+        hub() : clock( 0 )
+        {}
+
+        // 0 = whatever clock the calling thread uses
+        void set_clock( hid::virtual_clock *_clock )
+        {
+            clock = _clock;
+        }
+
+        template< typename DEVICE, typename... ARGS >
+        DEVICE &add( ARGS &&... args )
+        {
+            hid::clock_scope scope( clock ? clock : hid::thread_clock() );
+
+            model< DEVICE > *m = new model< DEVICE >( std::forward< ARGS >( args )... );
+            devices.push_back( std::unique_ptr< device >( m ) );
+            return m->instance;
+        }
+
+        size_t size() const
+        {
+            return devices.size();
+        }
+
+        void update()
+        {
+            changes.clear();
+
+            hid::clock_scope scope( clock ? clock : hid::thread_clock() );
+            hid::frame poll( global_timer, &changes );
+
+            for( auto &it : devices )
+                it->update();
+        }
+
+        // controls changed during last update(), in update order
+        const std::vector< const void * > &changed() const
+        {
+            return changes;
+        }
+
+        template< typename CONTROL >
+        bool changed( const CONTROL &control ) const
+        {
+            return std::find( changes.begin(), changes.end(), static_cast< const void * >( &control ) ) != changes.end();
+        }
+    };
+}
+
+namespace hyde
+{
+    // lock-free single-producer/single-consumer ring. N must be a power of two.
+    // push() from one thread, front()/pop() from another. when full, push() fails and counts a drop.
+
+    template< typename T, size_t N = 1024 >
+    class spsc
+    {
+        static_assert( N && !( N & ( N - 1 ) ), "N must be a power of two" );
+
+        std::array< T, N > slots;
+
+        // producer and consumer indices on separate cache lines
+        char pad0[ 64 ];
+        std::atomic< size_t > tail;     // next slot to write, owned by producer
+        char pad1[ 64 ];
+        std::atomic< size_t > head;     // next slot to read, owned by consumer
+        char pad2[ 64 ];
+        std::atomic< size_t > dropped;
+
+        spsc( const spsc & );
+        spsc &operator =( const spsc & );
+
+        public:
+
+        spsc() : tail(0), head(0), dropped(0)
+        {}
+
+        bool push( const T &item )
+        {
+            size_t t = tail.load( std::memory_order_relaxed );
+
+            if( t - head.load( std::memory_order_acquire ) == N )
+            {
+                dropped.fetch_add( 1, std::memory_order_relaxed );
+                return false;
+            }
+
+            slots[ t & ( N - 1 ) ] = item;
+            tail.store( t + 1, std::memory_order_release );
+            return true;
+        }
+
+        // oldest item, or 0 if empty
+        const T *front() const
+        {
+            size_t h = head.load( std::memory_order_relaxed );
+            return h == tail.load( std::memory_order_acquire ) ? 0 : &slots[ h & ( N - 1 ) ];
+        }
+
+        void pop()
+        {
+            assert( front() );
+            head.store( head.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+        }
+
+        size_t size() const
+        {
+            return tail.load( std::memory_order_acquire ) - head.load( std::memory_order_acquire );
+        }
+
+        size_t drops() const
+        {
+            return dropped.load( std::memory_order_relaxed );
+        }
+    };
+
+    // raw backend event, stamped when it was read. 'source' is the os timestamp of the event,
+    // converted to the same clock, or 0 if the backend has none
+    struct raw_event
+    {
+        hid::tick t;
+        unsigned short type, code;
+        int value;
+        hid::tick source;
+
+        // when it happened, as far as we know: samples are stamped with this
+        const hid::tick &when() const
+        {
+            return source ? source : t;
+        }
+    };
+
+    // latency_histogram: log2 buckets of nanoseconds, so percentiles are within 2x (upper bound
+    // of their bucket, never above maximum()). adding a sample is a bit scan and two increments.
+
+    class latency_histogram
+    {
+        // bucket b counts latencies in [2^b, 2^(b+1)) ns. bucket 0 also gets 0 and negative ones
+        std::array< std::uint64_t, 64 > buckets;
+        std::uint64_t total;
+        hid::tick highest;
+
+        public:
+
+        latency_histogram()
+        {
+            clear();
+        }
+
+        void clear()
+        {
+            buckets.fill( 0 );
+            total = 0;
+            highest = 0;
+        }
+
+        void add( const hid::tick &latency )
+        {
+            ++buckets[ log2( latency ) ];
+            ++total;
+
+            if( latency > highest )
+                highest = latency;
+        }
+
+        std::uint64_t count() const
+        {
+            return total;
+        }
+
+        // seconds
+        double percentile( double q ) const
+        {
+            std::uint64_t rank = (std::max)( std::uint64_t( std::ceil( q * total ) ), std::uint64_t( 1 ) ), seen = 0;
+
+            for( size_t b = 0; b < 64 && total; ++b )
+                if( ( seen += buckets[ b ] ) >= rank )
+                    return hid::dt::to_seconds( b < 62 ? (std::min)( ( hid::tick( 2 ) << b ) - 1, highest ) : highest );
+
+            return 0;
+        }
+
+        double p50() const
+        {
+            return percentile( 0.50 );
+        }
+
+        double p99() const
+        {
+            return percentile( 0.99 );
+        }
+
+        double maximum() const
+        {
+            return hid::dt::to_seconds( highest );
+        }
+
+        static size_t log2( const hid::tick &ns )
+        {
+            if( ns < 2 )
+                return 0;
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanReverse64( &index, std::uint64_t( ns ) );
+            return size_t( index );
+#elif defined(__GNUC__)
+            return size_t( 63 - __builtin_clzll( std::uint64_t( ns ) ) );
+#else
+            size_t n = 0;
+            for( std::uint64_t w = std::uint64_t( ns ); w >>= 1; ) ++n;
+            return n;
+#endif
+        }
+    };
+
+    // input_stats: per-device event counters, plus the latency of every event from its os
+    // timestamp (or from when it was read, if there is none) to the poll that made it visible to
+    // trigger() and friends. cheap enough to be always on.
+    //
+    // hyde::input_stats stats = keyboard.stats();
+    // stats.latency.p99()                          // seconds
+    // stats.processed, stats.coalesced, stats.dropped
+
+    struct input_stats
+    {
+        size_t processed;           // events read and applied
+        size_t coalesced;           // events merged into another sample (see motion_coalescer)
+        size_t dropped;             // events lost on the way (full queues)
+        latency_histogram latency;
+
+        input_stats() : processed( 0 ), coalesced( 0 ), dropped( 0 )
+        {}
+
+        // event made visible by the poll at 'visible'
+        void add( const hid::tick &visible, const raw_event &event )
+        {
+            latency.add( visible - event.when() );
+            ++processed;
+        }
+    };
+
+    // motion_coalescer: sums relative motion (ie, mouse counts) into a single sample per poll,
+    // or per time quantum within a poll, so a high rate mouse does not fill a history with
+    // sub-millisecond jitter. samples are stamped with the last event they sum up.
+    //
+    // hyde::motion_coalescer coalescing( 0.004 );            // seconds. 0 = one sample per poll
+    // coalescing.add( event.t, axis, event.value, emit );    // emit( t, dx, dy ) per sample
+    // coalescing.flush( emit );                              // before a button edge, and at end of poll
+    //
+    // flushing before button edges keeps them exact: motion before and after a click never merges.
+
+    class motion_coalescer
+    {
+        hid::tick quantum, first, last;
+        int delta[2];
+        bool pending;
+        size_t received, emitted;
+
+        public:
+
+        explicit motion_coalescer( double quantum_seconds = 0 ) :
+            quantum( hid::dt::to_ticks( quantum_seconds ) ), first( 0 ), last( 0 ), pending( false ), received( 0 ), emitted( 0 )
+        {
+            delta[0] = delta[1] = 0;
+        }
+
+        void set_quantum( double quantum_seconds )
+        {
+            quantum = hid::dt::to_ticks( quantum_seconds );
+        }
+
+        template< typename FN >
+        void add( const hid::tick &t, unsigned axis, int value, FN emit )
+        {
+            assert( axis < 2 );
+
+            if( pending && quantum > 0 && t - first >= quantum )
+                flush( emit );
+
+            if( !pending )
+                first = t, pending = true;
+
+            last = t;
+            delta[ axis ] += value;
+            ++received;
+        }
+
+        template< typename FN >
+        void flush( FN emit )
+        {
+            if( !pending )
+                return;
+
+            emit( last, delta[0], delta[1] );
+
+            delta[0] = delta[1] = 0;
+            pending = false;
+            ++emitted;
+        }
+
+        // relative motion events in (pre-coalescing), and samples out (post-coalescing)
+        size_t events() const
+        {
+            return received;
+        }
+
+        size_t samples() const
+        {
+            return emitted;
+        }
+    };
+
+    // input_thread: polls devices from a background thread at a fixed rate, so event timestamps
+    // do not depend on frame rate. devices added here stop polling inside their own update(), and
+    // just drain the events queued by the thread up to the frame timestamp instead.
+    //
+    // hyde::input_thread input( 1000 );   // hz
+    // input.add( keyboard );
+    // input.start();
+    // ...
+    // keyboard.update();                  // game thread, as usual
+    //
+    // devices must provide poll( hid::dt &clock ) (called from the thread) and set_threaded( bool ).
+    // the thread stamps events with its own timebase() copy of global_timer, so it never shares
+    // global_timer's frame state with the game thread.
+
+    class input_thread
+    {
+        struct entry
+        {
+            std::function< void( hid::dt & ) > poll;
+            std::function< void( bool ) > set_threaded;
+        };
+
+        std::vector< entry > devices;
+        std::chrono::nanoseconds period;
+        std::atomic< bool > running;
+        std::thread worker;
+
+        input_thread( const input_thread & );
+        input_thread &operator =( const input_thread & );
+
+        public:
+
+        explicit input_thread( double rate_hz = 1000.0 ) :
+            period( hid::dt::to_ticks( 1.0 / rate_hz ) ), running( false )
+        {}
+
+        ~input_thread()
+        {
+            stop();
+
+            for( auto &it : devices )
+                it.set_threaded( false );
+        }
+
+        template< typename DEVICE >
+        void add( DEVICE &device )
+        {
+            assert( !running && "add devices before start()" );
+
+            entry e;
+            e.poll = [&device]( hid::dt &clock ) { device.poll( clock ); };
+            e.set_threaded = [&device]( bool on ) { device.set_threaded( on ); };
+            e.set_threaded( true );
+
+            devices.push_back( e );
+        }
+
+        void start()
+        {
+            if( running.exchange( true ) )
+                return;
+
+            hid::dt clock = global_timer.timebase();
+
+            worker = std::thread( [this, clock]() mutable {
+                std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+                while( running.load( std::memory_order_relaxed ) )
+                {
+                    for( auto &it : devices )
+                        it.poll( clock );
+
+                    // after a stall (ie, process suspended) skip missed periods instead of
+                    // polling back to back until catching up
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+                    next += period;
+                    if( next + period < now )
+                        next = now;
+
+                    std::this_thread::sleep_until( next );
+                }
+            } );
+        }
+
+        void stop()
+        {
+            if( running.exchange( false ) )
+                worker.join();
+        }
+
+        bool is_running() const
+        {
+            return running;
+        }
+    };
+
+    // session logs: hyde::recorder appends every set() of the registered controls to a binary
+    // file, and hyde::replayer feeds it back into the same kind of controls.
+    //
+    // hyde::recorder rec( "session.rec" );
+    // rec.add( keyboard.keymap );              // controls get ids in add() order
+    // rec.add( mouse.left );
+    // rec.start();
+    // ...                                      // update devices as usual
+    // rec.stop();
+    //
+    // hyde::replayer play( "session.rec", hyde::replayer::realtime );
+    // play.add( keyboard.keymap );             // same order than when recording
+    // play.add( mouse.left );
+    // while( play.update() ) ...               // instead of keyboard.update(), mouse.update()
+    //
+    // format: "hyde.rec" and a version byte, then a stream of records:
+    //   varint( id << 1 | 1 ) varint( dims )                              declares control #id
+    //   varint( id << 1 | 0 ) zigzag( t - previous t ) value * dims       set() on control #id
+    // a value is varint( zigzag( x * 256 ) << 1 ) when exact (0, 0.5, 1, mouse counts...), or
+    // varint( float bits << 1 | 1 ) otherwise, so replayed values are bit exact.
+
+    namespace session
+    {
+        static const char magic[] = "hyde.rec\x01";
+        static const size_t magic_size = sizeof( magic ) - 1;
+
+        // worst case record: tag, time and 3 values, 10 bytes each
+        static const size_t max_record = 50;
+
+        inline void put_varint( std::vector< unsigned char > &out, std::uint64_t v )
+        {
+            for( ; v >= 0x80; v >>= 7 )
+                out.push_back( (unsigned char)( v | 0x80 ) );
+
+            out.push_back( (unsigned char)( v ) );
+        }
+
+        inline bool get_varint( const unsigned char *&p, const unsigned char *end, std::uint64_t &v )
+        {
+            v = 0;
+
+            for( unsigned shift = 0; p < end && shift < 64; shift += 7 )
+            {
+                unsigned char byte = *p++;
+                v |= std::uint64_t( byte & 0x7f ) << shift;
+
+                if( !( byte & 0x80 ) )
+                    return true;
+            }
+
+            return false;
+        }
+
+        inline std::uint64_t zigzag( std::int64_t v )
+        {
+            return ( std::uint64_t( v ) << 1 ) ^ std::uint64_t( v >> 63 );
+        }
+
+        inline std::int64_t unzigzag( std::uint64_t v )
+        {
+            return std::int64_t( v >> 1 ) ^ -std::int64_t( v & 1 );
+        }
+
+        inline void put_value( std::vector< unsigned char > &out, float x )
+        {
+            double q = double( x ) * 256.0;
+
+            if( q == std::floor( q ) && std::fabs( q ) < 1e15 && !( x == 0 && std::signbit( x ) ) )
+                return put_varint( out, zigzag( std::int64_t( q ) ) << 1 );
+
+            std::uint32_t bits;
+            std::memcpy( &bits, &x, sizeof( bits ) );
+            put_varint( out, std::uint64_t( bits ) << 1 | 1 );
+        }
+
+        inline bool get_value( const unsigned char *&p, const unsigned char *end, float &x )
+        {
+            std::uint64_t v;
+
+            if( !get_varint( p, end, v ) )
+                return false;
+
+            if( v & 1 )
+            {
+                std::uint32_t bits = std::uint32_t( v >> 1 );
+                std::memcpy( &x, &bits, sizeof( x ) );
+            }
+            else
+                x = float( unzigzag( v >> 1 ) / 256.0 );
+
+            return true;
+        }
+
+        template< typename HISTORY >
+        struct dims_of
+        {
+            typedef typename std::iterator_traits< typename HISTORY::const_iterator >::value_type sample;
+            static const size_t value = types::hid::traits< sample >::dims;
+        };
+
+        template< typename HISTORY >
+        typename dims_of< HISTORY >::sample sample_of( const HISTORY &, const float *v )
+        {
+            typedef typename dims_of< HISTORY >::sample sample;
+            typedef types::hid::traits< sample > traits;
+
+            sample s;
+            for( size_t d = 0; d < traits::dims; ++d )
+                s.*traits::value(d) = v[d];
+
+            return s;
+        }
+
+        // whole file, read-only and memory mapped: pages are loaded on demand, so multi-hour
+        // logs cost address space rather than memory
+        class mapped_file
+        {
+            const unsigned char *first;
+            size_t bytes;
+
+#ifdef _WIN32
+            HANDLE file, mapping;
+#endif
+
+            mapped_file( const mapped_file & );
+            mapped_file &operator =( const mapped_file & );
+
+            public:
+
+            explicit mapped_file( const std::string &path ) : first( 0 ), bytes( 0 )
+            {
+#ifdef _WIN32
+                mapping = 0;
+                file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+
+                LARGE_INTEGER size;
+
+                if( file == INVALID_HANDLE_VALUE || !GetFileSizeEx( file, &size ) || !size.QuadPart )
+                    return;
+
+                mapping = CreateFileMappingA( file, 0, PAGE_READONLY, 0, 0, 0 );
+
+                if( mapping && ( first = (const unsigned char *)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) ) != 0 )
+                    bytes = size_t( size.QuadPart );
+#else
+                int fd = open( path.c_str(), O_RDONLY );
+                struct stat info;
+
+                if( fd < 0 )
+                    return;
+
+                if( fstat( fd, &info ) == 0 && info.st_size > 0 )
+                {
+                    void *view = mmap( 0, size_t( info.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+
+                    if( view != MAP_FAILED )
+                        first = (const unsigned char *)view, bytes = size_t( info.st_size );
+                }
+
+                close( fd );    // the mapping keeps the file alive
+#endif
+            }
+
+            ~mapped_file()
+            {
+#ifdef _WIN32
+                if( first )
+                    UnmapViewOfFile( first );
+                if( mapping )
+                    CloseHandle( mapping );
+                if( file != INVALID_HANDLE_VALUE )
+                    CloseHandle( file );
+#else
+                if( first )
+                    munmap( (void *)first, bytes );
+#endif
+            }
+
+            const unsigned char *begin() const
+            {
+                return first;
+            }
+
+            const unsigned char *end() const
+            {
+                return first + bytes;
+            }
+
+            size_t size() const
+            {
+                return bytes;
+            }
+        };
+
+        template< typename HISTORY >
+        void set_at( HISTORY &h, const hid::tick &t, const float *v, std::integral_constant< size_t, 1 > )
+        {
+            h.set_at( t, v[0] );
+        }
+
+        template< typename HISTORY >
+        void set_at( HISTORY &h, const hid::tick &t, const float *v, std::integral_constant< size_t, 2 > )
+        {
+            h.set_at( t, v[0], v[1] );
+        }
+
+        template< typename HISTORY >
+        void set_at( HISTORY &h, const hid::tick &t, const float *v, std::integral_constant< size_t, 3 > )
+        {
+            h.set_at( t, v[0], v[1], v[2] );
+        }
+    }
+
+    class recorder : public hid::listener
+    {
+        std::ofstream file;
+
+        // records wait here until there is no room for another one
+        std::vector< unsigned char > buffer;
+        size_t capacity;
+
+        std::unordered_map< const void *, std::uint64_t > ids;
+        hid::tick last;
+        size_t records;
+
+        // linked: installed on global_timer, forwarding to 'previous'. a recorder stopped while
+        // another listener sits on top of it stays linked, as a pass-through, until it is on top again
+        bool recording, linked;
+        hid::listener *previous;
+
+        recorder( const recorder & );
+        recorder &operator =( const recorder & );
+
+        public:
+
+        explicit recorder( const std::string &path, size_t buffer_bytes = 64 * 1024 ) :
+            file( path.c_str(), std::ios::binary | std::ios::trunc ),
+            capacity( (std::max)( buffer_bytes, size_t( 256 ) ) ), last( 0 ), records( 0 ), recording( false ), linked( false ), previous( 0 )
+        {
+            buffer.reserve( capacity );
+            buffer.insert( buffer.end(), session::magic, session::magic + session::magic_size );
+        }
+
+        ~recorder()
+        {
+            stop();
+            assert( !linked && "stop listeners started after this recorder first" );
+            flush();
+        }
+
+        bool is_open() const
+        {
+            return file.good();
+        }
+
+        template< typename HISTORY >
+        void add( const HISTORY &control )
+        {
+            if( ids.count( &control ) )
+                return;
+
+            std::uint64_t id = ids.size();
+            ids[ &control ] = id;
+
+            reserve();
+            session::put_varint( buffer, id << 1 | 1 );
+            session::put_varint( buffer, session::dims_of< HISTORY >::value );
+        }
+
+        template< typename HISTORY >
+        void add( const std::vector< HISTORY > &controls )
+        {
+            for( auto &it : controls )
+                add( it );
+        }
+
+        // listeners are per thread: start() and stop() from the thread that updates the controls
+        void start()
+        {
+            if( !linked )
+                previous = global_timer.listen( this ), linked = true;
+
+            recording = true;
+        }
+
+        void stop()
+        {
+            recording = false;
+
+            // only unlink when on top, or whatever was installed after this would be dropped
+            if( linked && global_timer.listening() == this )
+                global_timer.listen( previous ), linked = false;
+        }
+
+        void flush()
+        {
+            file.write( reinterpret_cast< const char * >( buffer.data() ), buffer.size() );
+            file.flush();
+            buffer.clear();
+        }
+
+        // set() calls written so far
+        size_t size() const
+        {
+            return records;
+        }
+
+        void on_set( const void *control, const hid::tick &t, const float *values, size_t dims )
+        {
+            if( previous )
+                previous->on_set( control, t, values, dims );
+
+            auto found = ids.find( control );
+
+            if( !recording || found == ids.end() )
+                return;
+
+            reserve();
+            session::put_varint( buffer, found->second << 1 );
+            session::put_varint( buffer, session::zigzag( t - last ) );
+
+            for( size_t d = 0; d < dims; ++d )
+                session::put_value( buffer, values[d] );
+
+            last = t;
+            ++records;
+        }
+
+        protected:
+
+        void reserve()
+        {
+            if( buffer.size() + session::max_record > capacity )
+                flush();
+        }
+    };
+
+    // hyde::replayer also seeks: seek( seconds ) rebuilds every control as it was at that moment
+    // of the log, in O(log n) over a sparse index of checkpoints (one every 'interval' seconds of
+    // log, built by a single pass on first seek). a checkpoint keeps the read position and the
+    // value in effect of every non-zero control, so only 'warmup' seconds of records are replayed
+    // on top of it: enough for every predefined pattern (tclick spans 0.75 s).
+
+    class replayer
+    {
+        public:
+
+        enum mode
+        {
+            realtime,   // set() at recorded pace, from first update() on
+            fast,       // everything at first update(), as fast as possible
+            stepped     // one recorded timestamp per update()
+        };
+
+        private:
+
+        struct control
+        {
+            size_t dims;
+            std::function< void( const hid::tick &, const float * ) > set, reset;
+        };
+
+        struct checkpoint
+        {
+            hid::tick t, last;
+            size_t offset;
+            size_t values_begin, values_end;    // into 'snapshots'
+        };
+
+        struct held
+        {
+            std::uint64_t id;
+            float values[3];
+        };
+
+        session::mapped_file file;
+        const unsigned char *cursor;
+
+        std::vector< control > controls;
+        std::vector< size_t > declared;
+        mode speed;
+
+        // optional virtual clock, moved to every record as it is replayed
+        hid::virtual_clock *clock;
+
+        // recorded timestamps are shifted by 'offset', so the first record lands at first update()
+        hid::tick last, offset;
+        bool started;
+
+        // next set() record, decoded ahead
+        bool pending;
+        std::uint64_t id;
+        hid::tick t;
+        float values[3];
+
+        size_t records;
+
+        // seek index
+        double interval;
+        std::vector< checkpoint > index;
+        std::vector< held > snapshots;
+        hid::tick first_t, last_t;
+
+        replayer( const replayer & );
+        replayer &operator =( const replayer & );
+
+        public:
+
+        explicit replayer( const std::string &path, mode _speed = realtime, double index_interval = 1.0 ) :
+            file( path ), cursor( 0 ),
+            speed( _speed ), clock( 0 ), last( 0 ), offset( 0 ), started( false ), pending( false ), id( 0 ), t( 0 ), records( 0 ),
+            interval( index_interval ), first_t( 0 ), last_t( 0 )
+        {
+            if( file.size() >= session::magic_size && std::equal( session::magic, session::magic + session::magic_size, file.begin() ) )
+                cursor = file.begin() + session::magic_size;
+        }
+
+        // false if file is missing or not a session log
+        bool is_open() const
+        {
+            return cursor != 0;
+        }
+
+        void set_mode( mode _speed )
+        {
+            speed = _speed;
+        }
+
+        // drive a hid::virtual_clock: it is set to each record's time before the record is
+        // applied, so now() matches what it was when recording. use it with fast or stepped
+        // modes (in realtime mode, whoever advances the clock sets the pace).
+        void set_clock( hid::virtual_clock *_clock )
+        {
+            clock = _clock;
+        }
+
+        template< typename HISTORY >
+        void add( HISTORY &h )
+        {
+            typedef std::integral_constant< size_t, session::dims_of< HISTORY >::value > dims;
+
+            control c;
+            c.dims = dims::value;
+            c.set = [&h]( const hid::tick &t, const float *v ) { session::set_at( h, t, v, dims() ); };
+            c.reset = [&h]( const hid::tick &t, const float *v ) { h.reset( session::sample_of( h, v ), t ); };
+
+            controls.push_back( c );
+        }
+
+        template< typename HISTORY >
+        void add( std::vector< HISTORY > &list )
+        {
+            for( auto &it : list )
+                add( it );
+        }
+
+        // replays due records, as per mode. false once the log is over
+        bool update()
+        {
+            if( !pending && !decode() )
+                return false;
+
+            // single timestamp for the whole poll cycle
+            hid::clock_scope scope( clock ? clock : hid::thread_clock() );
+            hid::frame poll( global_timer );
+
+            hid::tick now = global_timer.now();
+
+            if( !started )
+                offset = now - t, started = true;
+
+            hid::tick step = t;
+
+            while( pending && ( speed == fast || ( speed == stepped ? t == step : t + offset <= now ) ) )
+            {
+                apply();
+                decode();
+            }
+
+            return pending;
+        }
+
+        // set() calls replayed so far
+        size_t size() const
+        {
+            return records;
+        }
+
+        // log length, in seconds
+        double duration()
+        {
+            build_index();
+            return hid::dt::to_seconds( last_t - first_t );
+        }
+
+        // jump to 'seconds' since the log start: every control is rebuilt as it was then, stamped
+        // as if that moment were now. replay goes on from there on next update().
+        bool seek( double seconds, double warmup = 2.0 )
+        {
+            build_index();
+
+            if( index.empty() )
+                return false;
+
+            hid::tick target = first_t + hid::dt::to_ticks( seconds );
+            hid::tick from = target - hid::dt::to_ticks( warmup );
+
+            // last checkpoint at or before 'from'
+            struct later
+            {
+                bool operator()( const hid::tick &t, const checkpoint &cp ) const
+                {
+                    return t < cp.t;
+                }
+            };
+
+            std::vector< checkpoint >::const_iterator cp = std::upper_bound( index.begin(), index.end(), from, later() );
+
+            if( cp != index.begin() )
+                --cp;
+
+            // single timestamp for the whole seek
+            hid::clock_scope scope( clock ? clock : hid::thread_clock() );
+            hid::frame poll( global_timer );
+
+            offset = global_timer.now() - target;
+            started = true;
+
+            // controls back to their value at the checkpoint: zero, unless snapshot says otherwise
+            static const float zeros[3] = {};
+
+            for( auto &it : controls )
+                it.reset( cp->t + offset, zeros );
+
+            for( size_t i = cp->values_begin; i < cp->values_end; ++i )
+                if( snapshots[i].id < controls.size() )
+                    controls[ size_t( snapshots[i].id ) ].reset( cp->t + offset, snapshots[i].values );
+
+            // ...and replay from there up to the target
+            cursor = file.begin() + cp->offset;
+            last = cp->last;
+
+            while( decode() && t <= target )
+                apply();
+
+            return true;
+        }
+
+        protected:
+
+        void apply()
+        {
+            if( clock && clock->now() < t + offset )
+                clock->set( t + offset );
+
+            if( id < controls.size() && id < declared.size() && controls[ size_t( id ) ].dims == declared[ size_t( id ) ] )
+                controls[ size_t( id ) ].set( t + offset, values );
+
+            pending = false;
+            ++records;
+        }
+
+        bool decode()
+        {
+            pending = false;
+
+            if( !cursor )
+                return false;
+
+            for( ;; )
+            {
+                const unsigned char *p = cursor, *end = file.end();
+                std::uint64_t tag, value;
+
+                if( !session::get_varint( p, end, tag ) )
+                    return false;
+
+                std::uint64_t which = tag >> 1;
+
+                if( tag & 1 )
+                {
+                    if( !session::get_varint( p, end, value ) || value < 1 || value > 3 )
+                        return false;
+
+                    if( declared.size() <= which )
+                        declared.resize( size_t( which + 1 ), 0 );
+
+                    declared[ size_t( which ) ] = size_t( value );
+                    cursor = p;
+                    continue;
+                }
+
+                // truncated or corrupt logs just end here
+                if( which >= declared.size() || !declared[ size_t( which ) ] || !session::get_varint( p, end, value ) )
+                    return false;
+
+                for( size_t d = 0; d < declared[ size_t( which ) ]; ++d )
+                    if( !session::get_value( p, end, values[d] ) )
+                        return false;
+
+                id = which;
+                t = last += session::unzigzag( value );
+                cursor = p;
+
+                return pending = true;
+            }
+        }
+
+        void build_index()
+        {
+            if( !index.empty() || !cursor )
+                return;
+
+            // scan the whole log once, with a private decoder state
+            const unsigned char *saved_cursor = cursor;
+            hid::tick saved_last = last, saved_t = t;
+            std::uint64_t saved_id = id;
+            bool saved_pending = pending;
+            float saved_values[3] = { values[0], values[1], values[2] };
+
+            cursor = file.begin() + session::magic_size;
+            last = 0;
+
+            std::vector< held > current;    // value in effect, per id
+            hid::tick step = hid::dt::to_ticks( interval ), next = 0;
+
+            for( ;; )
+            {
+                const unsigned char *at = cursor;
+                hid::tick before = last;
+
+                if( !decode() )
+                    break;
+
+                if( index.empty() )
+                    first_t = next = t;
+
+                if( t >= next )
+                {
+                    checkpoint cp = { t, before, size_t( at - file.begin() ), snapshots.size(), 0 };
+
+                    for( auto &it : current )
+                        if( it.values[0] != 0 || it.values[1] != 0 || it.values[2] != 0 )
+                            snapshots.push_back( it );
+
+                    cp.values_end = snapshots.size();
+                    index.push_back( cp );
+
+                    next = t + step;
+                }
+
+                for( size_t i = current.size(); i <= id; ++i )
+                {
+                    held zero = { i, { 0, 0, 0 } };
+                    current.push_back( zero );
+                }
+
+                held &v = current[ size_t( id ) ];
+                for( size_t d = 0; d < 3; ++d )
+                    v.values[d] = d < declared[ size_t( id ) ] ? values[d] : 0;
+
+                last_t = t;
+            }
+
+            cursor = saved_cursor;
+            last = saved_last, t = saved_t, id = saved_id, pending = saved_pending;
+            std::copy( saved_values, saved_values + 3, values );
+        }
+    };
+}
+
+
+namespace hyde
+{
+    // synthetic devices: same shape as the windows keyboard, mouse and gamepad, but fed by event
+    // generators instead of an OS API, so the whole pipeline (coalescing, history, keyplane and
+    // gesture queries) can be load-tested headless, at any rate.
+    //
+    // hyde::synthetic::keyboard kb;
+    // kb.add_generator( hyde::synthetic::random_generator( hyde::synthetic::KEY, 1e6, 256, 0, 1 ) );   // 1M events/s
+    // kb.update();                             // generates and applies every event due by now()
+    //
+    // generators are polled in update() up to global_timer.now(), so under a hid::virtual_clock
+    // a run is fully deterministic and can go faster than realtime.
+
+    namespace synthetic
+    {
+        // raw_event::type of synthetic events
+        enum event_type
+        {
+            KEY,        // code: keymap index (windows virtual-key layout), value: 0 released, else pressed
+            BUTTON,     // code: button index (see each device), value: 0 released, else pressed
+            MOTION,     // code: 0 x, 1 y. value: relative motion, in counts
+            SCROLL,     // code: 0 vertical, 1 horizontal. value: steps
+            AXIS        // code: axis index (see gamepad), value: thousandths, [-1000,1000]
+        };
+
+        // evenly spaced random events of one type: codes in [0,codes), values in [minimum,maximum].
+        // same seed, same sequence.
+        class random_generator
+        {
+            std::mt19937 rng;
+            unsigned short type;
+            unsigned codes;
+            int minimum, maximum;
+            hid::tick step, next;
+            bool started;
+
+            public:
+
+            random_generator( unsigned short _type, double rate, unsigned _codes, int _minimum, int _maximum, unsigned seed = 1 ) :
+                rng( seed ), type( _type ), codes( _codes ), minimum( _minimum ), maximum( _maximum ),
+                step( (std::max)( hid::dt::to_ticks( 1.0 / rate ), hid::tick( 1 ) ) ), next( 0 ), started( false )
+            {}
+
+            // every event due up to 'until'. first call starts the sequence at 'until'
+            template< typename FN >
+            void generate( const hid::tick &until, FN emit )
+            {
+                if( !started )
+                    next = until, started = true;
+
+                for( ; next <= until; next += step )
+                {
+                    raw_event event = { next, type, (unsigned short)( rng() % codes ), minimum + int( rng() % unsigned( maximum - minimum + 1 ) ), 0 };
+                    emit( event );
+                }
+            }
+        };
+
+        // a fixed list of events, timed relative to the first update(). optionally looped.
+        // a non-zero raw_event::source is relative too, ie { 10 ms, KEY, 'A', 1, 8 ms } happened 2 ms before it was read
+        class scripted_generator
+        {
+            std::vector< raw_event > script;
+            hid::tick origin, span;
+            size_t pos;
+            bool looping, started;
+
+            public:
+
+            scripted_generator( const std::vector< raw_event > &events, bool loop = false ) :
+                script( events ), origin( 0 ), span( 0 ), pos( 0 ), looping( loop ), started( false )
+            {
+                struct earlier
+                {
+                    bool operator()( const raw_event &a, const raw_event &b ) const
+                    {
+                        return a.t < b.t;
+                    }
+                };
+
+                std::stable_sort( script.begin(), script.end(), earlier() );
+
+                if( !script.empty() )
+                    span = script.back().t + 1;
+            }
+
+            template< typename FN >
+            void generate( const hid::tick &until, FN emit )
+            {
+                if( !started )
+                    origin = until, started = true;
+
+                while( pos < script.size() && origin + script[ pos ].t <= until )
+                {
+                    raw_event event = script[ pos++ ];
+                    event.t += origin;
+                    event.source = event.source ? event.source + origin : 0;
+                    emit( event );
+
+                    if( pos == script.size() && looping )
+                        pos = 0, origin += span;
+                }
+            }
+        };
+
+        // generators of a device, merged in time order
+        class source
+        {
+            std::vector< std::function< void( const hid::tick &, std::vector< raw_event > & ) > > generators;
+            std::vector< raw_event > batch;
+            size_t count;
+            input_stats counters;
+
+            public:
+
+            source() : count( 0 )
+            {}
+
+            template< typename GENERATOR >
+            void add( const GENERATOR &generator )
+            {
+                GENERATOR g( generator );
+
+                generators.push_back( [g]( const hid::tick &until, std::vector< raw_event > &out ) mutable {
+                    g.generate( until, [&]( const raw_event &event ) { out.push_back( event ); } );
+                } );
+            }
+
+            template< typename FN >
+            void drain( const hid::tick &until, FN apply )
+            {
+                batch.clear();
+
+                for( auto &it : generators )
+                    it( until, batch );
+
+                if( generators.size() > 1 )
+                {
+                    struct earlier
+                    {
+                        bool operator()( const raw_event &a, const raw_event &b ) const
+                        {
+                            return a.t < b.t;
+                        }
+                    };
+
+                    std::stable_sort( batch.begin(), batch.end(), earlier() );
+                }
+
+                for( auto &it : batch )
+                {
+                    counters.add( until, it );
+                    apply( it );
+                }
+
+                count += batch.size();
+            }
+
+            // events generated so far
+            size_t events() const
+            {
+                return count;
+            }
+
+            // latency from event time to the update() that applied it
+            const input_stats &stats() const
+            {
+                return counters;
+            }
+        };
+
+        class keyboard
+        {
+            source generators;
+
+            public:
+
+            const char *const typeof;
+
+            // indexed by windows virtual-key codes
+            hyde::buttons keymap;
+            hyde::serializers serial;
+
+            hyde::button &a, &b, &c, &d, &e, &f, &g, &h, &i, &j, &k, &l,
+                &m, &n, &o, &p, &q, &r, &s, &t, &u, &v, &w, &x, &y, &z,
+                &one, &two, &three, &four, &five, &six, &seven, &eight, &nine, &zero,
+                &escape, &backspace, &tab, &enter, &shift, &ctrl, &alt, &space,
+                &up, &down, &left, &right, &home, &end, &insert, &del,
+                &f1, &f2, &f3, &f4, &f5, &f6, &f7, &f8, &f9, &f10, &f11, &f12,
+                &numpad1, &numpad2, &numpad3, &numpad4, &numpad5,
+                &numpad6, &numpad7, &numpad8, &numpad9, &numpad0,
+                &add, &subtract, &multiply, &divide, &separator, &decimal;
+
+            hyde::button debug_key;
+
+            hyde::flag is_ready;
+
+            // see hyde::windows::keyboard::keystate
+            hyde::keyplane keystate;
+
+            keyboard() :
+                typeof( "hyde::synthetic::keyboard" ),
+                keymap( hyde::keybits::capacity ), serial( 1 ),
+                a( keymap[ 'A' ] ), b( keymap[ 'B' ] ), c( keymap[ 'C' ] ), d( keymap[ 'D' ] ),
+                e( keymap[ 'E' ] ), f( keymap[ 'F' ] ), g( keymap[ 'G' ] ), h( keymap[ 'H' ] ),
+                i( keymap[ 'I' ] ), j( keymap[ 'J' ] ), k( keymap[ 'K' ] ), l( keymap[ 'L' ] ),
+                m( keymap[ 'M' ] ), n( keymap[ 'N' ] ), o( keymap[ 'O' ] ), p( keymap[ 'P' ] ),
+                q( keymap[ 'Q' ] ), r( keymap[ 'R' ] ), s( keymap[ 'S' ] ), t( keymap[ 'T' ] ),
+                u( keymap[ 'U' ] ), v( keymap[ 'V' ] ), w( keymap[ 'W' ] ), x( keymap[ 'X' ] ),
+                y( keymap[ 'Y' ] ), z( keymap[ 'Z' ] ),
+                one( keymap[ '1' ] ), two( keymap[ '2' ] ), three( keymap[ '3' ] ), four( keymap[ '4' ] ),
+                five( keymap[ '5' ] ), six( keymap[ '6' ] ), seven( keymap[ '7' ] ), eight( keymap[ '8' ] ),
+                nine( keymap[ '9' ] ), zero( keymap[ '0' ] ),
+                escape( keymap[ 0x1B ] ), backspace( keymap[ 0x08 ] ), tab( keymap[ 0x09 ] ),
+                enter( keymap[ 0x0D ] ), shift( keymap[ 0x10 ] ), ctrl( keymap[ 0x11 ] ),
+                alt( keymap[ 0x12 ] ), space( keymap[ 0x20 ] ),
+                up( keymap[ 0x26 ] ), down( keymap[ 0x28 ] ), left( keymap[ 0x25 ] ), right( keymap[ 0x27 ] ),
+                home( keymap[ 0x24 ] ), end( keymap[ 0x23 ] ), insert( keymap[ 0x2D ] ), del( keymap[ 0x2E ] ),
+                f1( keymap[ 0x70 ] ), f2( keymap[ 0x71 ] ), f3( keymap[ 0x72 ] ), f4( keymap[ 0x73 ] ),
+                f5( keymap[ 0x74 ] ), f6( keymap[ 0x75 ] ), f7( keymap[ 0x76 ] ), f8( keymap[ 0x77 ] ),
+                f9( keymap[ 0x78 ] ), f10( keymap[ 0x79 ] ), f11( keymap[ 0x7A ] ), f12( keymap[ 0x7B ] ),
+                numpad1( keymap[ 0x61 ] ), numpad2( keymap[ 0x62 ] ), numpad3( keymap[ 0x63 ] ),
+                numpad4( keymap[ 0x64 ] ), numpad5( keymap[ 0x65 ] ), numpad6( keymap[ 0x66 ] ),
+                numpad7( keymap[ 0x67 ] ), numpad8( keymap[ 0x68 ] ), numpad9( keymap[ 0x69 ] ),
+                numpad0( keymap[ 0x60 ] ),
+                add( keymap[ 0x6B ] ), subtract( keymap[ 0x6D ] ), multiply( keymap[ 0x6A ] ),
+                divide( keymap[ 0x6F ] ), separator( keymap[ 0x6C ] ), decimal( keymap[ 0x6E ] )
+            {
+                // same timestamp for keystate and every key, so bulk and per-key queries agree.
+                // a local tick, not a frame: devices may be built on any thread
+                hid::tick now = global_timer.now();
+
+                keystate.reset( now );
+
+                for( auto &it : keymap )
+                {
+                    it.clear( now );
+                    it.age_from( &keystate.polls() );
+                }
+
+                is_ready.set( 0.5f );
+            }
+
+            static const size_t max_devices = 1;
+
+            template< typename GENERATOR >
+            void add_generator( const GENERATOR &generator )
+            {
+                generators.add( generator );
+            }
+
+            size_t events() const
+            {
+                return generators.events();
+            }
+
+            input_stats stats() const
+            {
+                return generators.stats();
+            }
+
+            void clear()
+            {
+                hid::tick now = global_timer.now();
+
+                keystate.reset( now );
+
+                for( auto &it : keymap )
+                    it.clear( now );
+
+                for( auto &it : serial )
+                    it.clear();
+
+                debug_key.clear();
+                is_ready.clear();
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                hid::tick now = global_timer.now();
+
+                // keys are set event by event, so taps shorter than a poll still leave a trail
+                generators.drain( now, [&]( const raw_event &event ) {
+                    if( event.type == KEY && event.code < hyde::keybits::capacity )
+                    {
+                        hyde::keybits next = keystate.state();
+                        next.set( event.code, event.value != 0 );
+
+                        keystate.set( next, event.t ).for_each( [&]( size_t key ) {
+                            keymap[ key ].set_at( event.t, event.value ? 0.5f : 0.f );
+                        } );
+                    }
+                } );
+
+                // no flips: just age everything
+                keystate.update( keystate.state(), now );
+
+                is_ready.set( 0.5f );
+            }
+        };
+
+        class mouse
+        {
+            source generators;
+            int mx, my;
+            float dx, dy;
+
+            // buttons are only set on events, and age lazily from here (see history::age_from())
+            hid::polls polled;
+
+            public:
+
+            enum button_enumeration
+            {
+                LEFT,
+                MIDDLE,
+                RIGHT
+            };
+
+            enum flag_enumeration
+            {
+                HOVER,
+                CONNECTED,
+                HIDDEN,
+                CLIPPED,
+                CENTERED
+            };
+
+            enum axis_enumeration
+            {
+                WHEEL,
+                LOCAL,
+                GLOBAL,
+                CLIENT,
+                DESKTOP,
+                MOTION
+            };
+
+            hyde::flags flags;
+            hyde::buttons buttons;
+            hyde::coordinates coordinates;
+
+            hyde::button &left, &middle, &right;
+            hyde::coordinate &wheel, &local, &global, &client, &desktop, &motion;
+            hyde::flag &hover, &connected, &hidden, &clipped, &centered;
+
+            // see hyde::windows::mouse::coalescing
+            hyde::motion_coalescer coalescing;
+
+            mouse() :
+                mx( 0 ), my( 0 ), dx( 0 ), dy( 0 ),
+                flags( 5 ), buttons( 3 ), coordinates( 6 ),
+                left( buttons[ LEFT ] ), middle( buttons[ MIDDLE ] ), right( buttons[ RIGHT ] ),
+                wheel( coordinates[ WHEEL ] ), local( coordinates[ LOCAL ] ), global( coordinates[ GLOBAL ] ),
+                client( coordinates[ CLIENT ] ), desktop( coordinates[ DESKTOP ] ), motion( coordinates[ MOTION ] ),
+                hover( flags[ HOVER ] ), connected( flags[ CONNECTED ] ), hidden( flags[ HIDDEN ] ),
+                clipped( flags[ CLIPPED ] ), centered( flags[ CENTERED ] ),
+                typeof( "hyde::synthetic::mouse" )
+            {
+                polled = hid::polls( global_timer.now() );
+
+                for( auto &it : buttons )
+                    it.age_from( &polled );
+            }
+
+            const char *const typeof;
+
+            static const size_t max_devices = 1;
+
+            template< typename GENERATOR >
+            void add_generator( const GENERATOR &generator )
+            {
+                generators.add( generator );
+            }
+
+            size_t events() const
+            {
+                return generators.events();
+            }
+
+            input_stats stats() const
+            {
+                input_stats out = generators.stats();
+                out.coalesced = coalescing.events() - coalescing.samples();
+                return out;
+            }
+
+            void clear()
+            {
+                for( auto &it : buttons )
+                    it.clear();
+                for( auto &it : coordinates )
+                    it.clear();
+                for( auto &it : flags )
+                    it.clear();
+
+                polled = hid::polls( global_timer.now() );
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                auto emit = [&]( const hid::tick &t, int x, int y ) {
+                    motion.set_at( t, float( mx += x ), float( my += y ) );
+                };
+
+                // buttons flush pending motion first, as in hyde::linux_evdev::mouse
+                generators.drain( global_timer.now(), [&]( const raw_event &event ) {
+                    if( event.type == synthetic::MOTION && event.code < 2 )   // not axis_enumeration::MOTION
+                        coalescing.add( event.t, event.code, event.value, emit );
+                    else if( event.type == BUTTON && event.code < 3 )
+                    {
+                        coalescing.flush( emit );
+                        buttons[ event.code ].set_at( event.t, event.value ? 0.5f : 0.f );
+                    }
+                    else if( event.type == SCROLL )
+                    {
+                        ( event.code ? dx : dy ) += ( event.value > 0 ? 1 : -1 ) * 0.100f;
+                        wheel.set_at( event.t, dx, dy );
+                    }
+                } );
+
+                coalescing.flush( emit );
+
+                polled.advance( global_timer.now() );
+
+                connected.set( 0.5f );
+            }
+        };
+
+        class gamepad
+        {
+            source generators;
+
+            // axis values, in thousandths
+            enum { LX, LY, RX, RY, LT, RT, HX, HY, AXES };
+            int axis[ AXES ];
+
+            // buttons are only set on events, and age lazily from here (see history::age_from())
+            hid::polls polled;
+
+            public:
+
+            // 10x buttons,   1d data input (action)
+            //  2x triggers,  1d data input (action)
+            hyde::button
+                a, b, x, y,
+                back, start,
+                lb, rb,
+                lthumb, rthumb,
+                ltrigger, rtrigger;
+
+            //  2x axis,      2d data input (spatial)
+            //  1x gamepad,   2d data input (spatial)
+            hyde::coordinate
+                pad,
+                lpad, rpad;
+
+            //  1x mic,       1d data output (mono audio)
+            hyde::button
+                mic;
+
+            //  1x earphones, 2d data output (stereo audio)
+            hyde::coordinates
+                earphones;
+
+            // 47x keys,      1d data input (text)
+            hyde::keys
+                keymap;
+
+            // 2x rumble,     1d data output (rumble haptic)
+            hyde::buttons rumble;
+
+            hyde::flag
+                is_ready;
+
+            // BUTTON codes: a, b, x, y, back, start, lb, rb, lthumb, rthumb.
+            // AXIS codes: lx, ly, rx, ry, ltrigger, rtrigger, pad x, pad y
+            gamepad() :
+                earphones( 1 ), keymap( 47 ), rumble( 2 ),
+                typeof( "hyde::synthetic::gamepad" )
+            {
+                hyde::button *buttons[] = { &a, &b, &x, &y, &back, &start, &lb, &rb, &lthumb, &rthumb };
+
+                std::fill( axis, axis + AXES, 0 );
+
+                polled = hid::polls( global_timer.now() );
+
+                for( auto *it : buttons )
+                    it->age_from( &polled );
+
+                is_ready.set( 0.5f );
+            }
+
+            const char *const typeof;
+            static const size_t max_devices = 4;
+
+            template< typename GENERATOR >
+            void add_generator( const GENERATOR &generator )
+            {
+                generators.add( generator );
+            }
+
+            size_t events() const
+            {
+                return generators.events();
+            }
+
+            input_stats stats() const
+            {
+                return generators.stats();
+            }
+
+            void clear()
+            {
+                a.clear();
+                b.clear();
+                x.clear();
+                y.clear();
+                back.clear();
+                start.clear();
+                lb.clear();
+                rb.clear();
+                lthumb.clear();
+                rthumb.clear();
+                ltrigger.clear();
+                rtrigger.clear();
+                pad.clear();
+                lpad.clear();
+                rpad.clear();
+                mic.clear();
+                is_ready.clear();
+
+                for( auto &it : earphones )
+                    it.clear();
+
+                for( auto &it : keymap )
+                    it.clear();
+
+                for( auto &it : rumble )
+                    it.clear();
+
+                polled = hid::polls( global_timer.now() );
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                hyde::button *buttons[] = { &a, &b, &x, &y, &back, &start, &lb, &rb, &lthumb, &rthumb };
+
+                // buttons event by event; axes once per poll, stamped at their last event
+                hid::tick moved = 0;
+
+                generators.drain( global_timer.now(), [&]( const raw_event &event ) {
+                    if( event.type == BUTTON && event.code < 10 )
+                        buttons[ event.code ]->set_at( event.t, event.value ? 1.f : 0.f );
+                    else if( event.type == AXIS && event.code < AXES )
+                        axis[ event.code ] = (std::max)( -1000, (std::min)( 1000, event.value ) ), moved = event.t;
+                } );
+
+                polled.advance( global_timer.now() );
+
+                hid::tick t = moved ? moved : global_timer.now();
+
+                ltrigger.set_at( t, axis[ LT ] < 0 ? 0.f : axis[ LT ] / 1000.f );
+                rtrigger.set_at( t, axis[ RT ] < 0 ? 0.f : axis[ RT ] / 1000.f );
+
+                pad.set_at( t, axis[ HX ] / 1000.f, axis[ HY ] / 1000.f );
+                lpad.set_at( t, axis[ LX ] / 1000.f, axis[ LY ] / 1000.f );
+                rpad.set_at( t, axis[ RX ] / 1000.f, axis[ RY ] / 1000.f );
+
+                is_ready.set( 0.5f );
+            }
+        };
+    }
+}
+
+
+#ifdef _WIN32
+
+#include <limits>
+#include <set>
+
+#include <cassert>
+#include <iostream>
+
+#include <map>
+
+#include <cassert>
+#include <winsock2.h>
+#include <Windows.h>
+#include <mmsystem.h>                   // joystick
+#include <XInput.h>                     // gamepad360
+
+#pragma comment(lib, "winmm.lib")       // joystick
+#pragma comment(lib, "XInput.lib")      // gamepad360
+#pragma comment(lib, "user32.lib")      // GetAsyncKeyState [...]
+
+#include "deps/manymouse/manymouse.h"
+
+namespace hyde
+{
+    // sharing_policy: instances of a device class with the same id share one state block, and
+    // only one of them (the master) polls the device. the others (slaves) reference the very same
+    // histories, so there is nothing to copy on update().
+    //
+    // a fixed table of T::max_devices slots per device class, indexed by id. refcounts are atomic
+    // and a mutex guards attach/detach, so instances can come and go from any thread. when the
+    // master goes away, the next instance to update() takes over polling, under that same mutex.
+    //
+    // T::state is the shared block: constructed on first attach(), destroyed on last detach().
+    // whoever writes it (update(), clear()) holds a sharing_policy::writer for the duration.
+    // each instance is updated by one thread at a time, and instances of the same id may be
+    // updated from different threads: only the master writes, and frames and listeners of
+    // hyde::global_timer are per thread, so a recorder only logs the updates of its own thread.
+    //
+    // reads through the members (ie, pad.a.hold()) take no lock, so they are only safe on the
+    // thread that updates the master: the master may write them at any time from there. keep
+    // every instance of an id on one thread to read them directly. any other thread (or a
+    // replay) reads a snapshot() instead: a copy made on demand, between writers, and shared
+    // by every snapshot() until the next writer is done (copy-on-write).
+
+    class sharing_policy
+    {
+        template< typename T >
+        struct slot
+        {
+            std::atomic< size_t > refs;
+            std::atomic< const T * > master;
+            typename T::state *block;
+
+            // held by writers and snapshot(). recursive, as update() may clear()
+            std::recursive_mutex write;
+
+            // bumped as each writer is done. 'frozen' is the copy of 'block' as of generation
+            // 'frozen_at'. all three only change under 'write'
+            std::uint64_t generation;
+            std::shared_ptr< const typename T::state > frozen;
+            std::uint64_t frozen_at;
+        };
+
+        // one extra slot catches invalid ids, so those instances still get a (dead) state
+        template< typename T >
+        static slot< T > &at( size_t id )
+        {
+            static std::array< slot< T >, T::max_devices + 1 > slots;
+            return slots[ (std::min)( id, size_t( T::max_devices ) ) ];
+        }
+
+        static std::mutex &lock()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        public:
+
+        // registers an instance of id, and returns the state shared by every instance of it
+        template< typename T >
+        static typename T::state &attach( const T &controller, size_t id )
+        {
+            std::lock_guard< std::mutex > guard( lock() );
+
+            slot< T > &s = at< T >( id );
+
+            if( s.refs.fetch_add( 1 ) == 0 )
+                s.block = new typename T::state();
+
+            const T *none = 0;
+            s.master.compare_exchange_strong( none, &controller );
+
+            return *s.block;
+        }
+
+        // unregisters an instance. last one out destroys the state
+        template< typename T >
+        static void detach( const T &controller, size_t id )
+        {
+            std::lock_guard< std::mutex > guard( lock() );
+
+            slot< T > &s = at< T >( id );
+
+            const T *self = &controller;
+            s.master.compare_exchange_strong( self, 0 );
+
+            if( s.refs.fetch_sub( 1 ) == 1 )
+            {
+                std::lock_guard< std::recursive_mutex > write( s.write );
+
+                delete s.block;
+                s.block = 0;
+                s.frozen.reset();
+            }
+        }
+
+        // true if controller is the master of id right now. never takes over, so constructors
+        // and destructors can ask without becoming the master of a device they do not update
+        template< typename T >
+        static bool owns( const T &controller, size_t id )
+        {
+            return at< T >( id ).master.load( std::memory_order_acquire ) == &controller;
+        }
+
+        // true if controller polls id, taking over if the master is gone: for update() only.
+        // lock-free, unless taking over: the hand-off goes through the same mutex than detach(),
+        // so the new master sees every write of the previous one
+        template< typename T >
+        static bool is_master( const T &controller, size_t id )
+        {
+            slot< T > &s = at< T >( id );
+
+            const T *current = s.master.load( std::memory_order_acquire );
+
+            if( current )
+                return current == &controller;
+
+            std::lock_guard< std::mutex > guard( lock() );
+
+            return s.master.compare_exchange_strong( current, &controller ) || current == &controller;
+        }
+
+        // live instances of id
+        template< typename T >
+        static size_t instances( size_t id )
+        {
+            return at< T >( id ).refs.load( std::memory_order_relaxed );
+        }
+
+        // scope of a write to the state of id. snapshot() waits for it, and the generation is
+        // bumped on the way out, after the write, so next snapshot() copies the new state
+        template< typename T >
+        class writer
+        {
+            slot< T > &s;
+
+            writer( const writer & );
+            writer &operator =( const writer & );
+
+            public:
+
+            writer( const T &controller, size_t id ) : s( at< T >( id ) )
+            {
+                s.write.lock();
+            }
+
+            ~writer()
+            {
+                ++s.generation;
+                s.write.unlock();
+            }
+        };
+
+        // frozen copy of the state of id, as of last writer. controller must be attached
+        template< typename T >
+        static std::shared_ptr< const typename T::state > snapshot( const T &controller, size_t id )
+        {
+            slot< T > &s = at< T >( id );
+
+            std::lock_guard< std::recursive_mutex > guard( s.write );
+
+            if( !s.frozen || s.frozen_at != s.generation )
+            {
+                s.frozen = std::shared_ptr< const typename T::state >( new typename T::state( *s.block ) );
+                s.frozen_at = s.generation;
+            }
+
+            return s.frozen;
+        }
+    };
+
+    namespace windows_wip
+    {
+
+        class joystick
+        {
+            UINT joy_id;
+
+            public:
+
+            hyde::flag is_ready;
+            hyde::coordinate xy;
+            hyde::buttons buttons;
+
+            // http://www.gnu-darwin.org/www001/src/ports/graphics/gephex/work/gephex-0.4.3/util/src/libjoystick/win32joystickdriver.cpp
+            // http://www.gnu-darwin.org/www001/src/ports/graphics/gephex/work/gephex-0.4.3/util/src/libjoystick/
+
+            joystick( unsigned id )
+            {
+                assert( id <  2 && "invalid joystick id" ); /* // nt [0.. 1]
+                assert( id < 16 && "invalid joystick id" ); */ // xp [0..15]
+
+                joy_id = JOYSTICKID1 + id;
+
+                // calibrate
+                // WinExec("control joy.cpl", SW_NORMAL);
+
+                /*
+                MMRESULT mr;
+                JOYCAPS jc;
+
+                mr = joyGetDevCaps(handle, &jc, sizeof(jc));
+
+                if (mr != JOYERR_NOERROR)
+                {
+                    throw std::runtime_error("Could not get caps for joystick");
+                }
+
+                m_num_axes      = jc.wNumAxes;
+                m_num_buttons   = jc.wNumButtons;
+                m_state.axes    = std::vector<int>(m_num_axes, 0);
+                m_state.buttons = std::vector<bool>(m_num_buttons, false);
+                */
+            }
+
+            void clear()
+            {
+                is_ready.clear();
+                xy.clear();
+
+                for( auto &it : buttons )
+                    it.clear();
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                if( !GetFocus() )
+                {
+                    if( GetForegroundWindow() != GetConsoleWindow() )
+                    {
+                        clear();
+                        return;
+                    }
+                }
+
+                //typedef struct joyinfoex_tag {
+                //    DWORD dwSize;                /* size of structure */
+                //    DWORD dwFlags;               /* flags to indicate what to return */
+                //    DWORD dwXpos;                /* x position */
+                //    DWORD dwYpos;                /* y position */
+                //    DWORD dwZpos;                /* z position */ <-- throttle
+                //    DWORD dwRpos;                /* rudder/4th axis position */ <-- pedals
+                //    DWORD dwUpos;                /* 5th axis position */
+                //    DWORD dwVpos;                /* 6th axis position */
+                //    DWORD dwButtons;             /* button states */
+                //    DWORD dwButtonNumber;        /* current button number pressed */
+                //    DWORD dwPOV;                 /* point of view state */
+                //    DWORD dwReserved1;           /* reserved for communication between winmm & driver */
+                //    DWORD dwReserved2;           /* reserved for future expansion */
+                //} JOYINFOEX, *PJOYINFOEX, NEAR *NPJOYINFOEX, FAR *LPJOYINFOEX;
+
+                JOYCAPS joyCaps;
+                joyGetDevCaps(joy_id, &joyCaps, sizeof(joyCaps));
+                BOOL has_throttle = (joyCaps.wCaps & JOYCAPS_HASZ);
+
+                JOYINFOEX joyInfoEx;
+                ZeroMemory(&joyInfoEx, sizeof(joyInfoEx));
+
+                joyInfoEx.dwSize = sizeof(joyInfoEx);
+                joyInfoEx.dwFlags = JOY_RETURNALL | JOY_RETURNCENTERED | JOY_USEDEADZONE | (has_throttle ? JOY_RETURNZ : 0);
+
+                BOOL is_present = (joyGetPosEx(joy_id, &joyInfoEx) == JOYERR_NOERROR);
+                is_ready.set( is_present ? 1.f : 0.f );
+
+                if( is_present )
+                {
+                    // vec6 !
+                    /*
+                    axes[0] = joyInfoEx.dwXpos;
+                    axes[1] = joyInfoEx.dwYpos;
+                    if (m_num_axes > 2)
+                        m_state.axes[2] = joyInfoEx.dwZpos; // throttle? sure?
+                    if (m_num_axes > 3)
+                        m_state.axes[3] = joyInfoEx.dwRpos;
+                    if (m_num_axes > 4)
+                        m_state.axes[4] = joyInfoEx.dwUpos;
+                    if (m_num_axes > 5)
+                        m_state.axes[5] = joyInfoEx.dwVpos;
+                    */
+
+                    size_t num_buttons = buttons.size();
+                    for( size_t i = 0; i < num_buttons; ++i )
+                        buttons[i].set( (joyInfoEx.dwButtons & (JOY_BUTTON1+i) ) ? 1 : 0 );
+                }
+            }
+        };
+    }
+
+    namespace windows
+    {
+        class gamepad
+        {
+            public:
+
+                // everything polled, shared by every gamepad of the same id (see sharing_policy)
+                struct state
+                {
+                    hyde::button a, b, x, y, back, start, lb, rb, lthumb, rthumb, ltrigger, rtrigger;
+                    hyde::coordinate pad, lpad, rpad;
+                    hyde::button mic;
+                    hyde::coordinates earphones;
+                    hyde::keys keymap;
+                    hyde::buttons rumble;
+                    hyde::flag is_ready;
+
+                    state() : earphones( 1 ), keymap( 47 ), rumble( 2 )
+                    {}
+                };
+
+            private:
+
+                XINPUT_STATE xinput;
+                DWORD id;
+
+                state &shared;
+
+                gamepad( const gamepad & );
+                gamepad &operator =( const gamepad & );
+
+            public:
+
+                // pad pieces
+
+                // 10x buttons,   1d data input (action)
+                //  2x triggers,  1d data input (action)
+                hyde::button
+                    &a, &b, &x, &y,
+                    &back, &start,
+                    &lb, &rb,
+                    &lthumb, &rthumb,
+                    &ltrigger, &rtrigger;
+
+                //  2x axis,      2d data input (spatial)
+                //  1x gamepad,   2d data input (spatial)
+                hyde::coordinate
+                    &pad,
+                    &lpad, &rpad;
+
+                //  1x mic,       1d data output (mono audio)
+                hyde::button
+                    &mic;
+
+                //  1x earphones, 2d data output (stereo audio)
+                hyde::coordinates
+                    &earphones;
+
+                // 47x keys,      1d data input (text)
+                hyde::keys
+                    &keymap;
+
+                // 2x rumble,     1d data output (rumble haptic)
+                hyde::buttons &rumble;
+
+                hyde::flag
+                    &is_ready;   // ~? is_present, is_plugged, is_connected
+
+            gamepad( const unsigned &_id ) :
+                id(_id),
+                shared( sharing_policy::attach( *this, _id ) ),
+                a( shared.a ), b( shared.b ), x( shared.x ), y( shared.y ),
+                back( shared.back ), start( shared.start ),
+                lb( shared.lb ), rb( shared.rb ),
+                lthumb( shared.lthumb ), rthumb( shared.rthumb ),
+                ltrigger( shared.ltrigger ), rtrigger( shared.rtrigger ),
+                pad( shared.pad ), lpad( shared.lpad ), rpad( shared.rpad ),
+                mic( shared.mic ),
+                earphones( shared.earphones ),
+                keymap( shared.keymap ),
+                rumble( shared.rumble ),
+                is_ready( shared.is_ready ),
+                typeof( "hyde::windows::gamepad" )
+            {
+
+                if( id >= max_devices )
+                {
+                    std::cerr << "error: device id #" << id << " invalid! (seen at " << typeof << " controller)" << std::endl;
+                    assert( false );
+                    return;
+                }
+
+                if( sharing_policy::owns( *this, id ) )
+                    set_rumble( 0.f, 0.f );
+
+//                ltrigger.newest().deadzone = 0.1f;
+//                rtrigger.newest().deadzone = 0.1f;
+            }
+
+            ~gamepad()
+            {
+                if( sharing_policy::owns( *this, id ) )
+                    set_rumble( 0.f, 0.f );
+
+                sharing_policy::detach( *this, id );
+            }
+
+            const char *const typeof;
+            static const size_t max_devices = 4;
+
+            protected:
+
+            XINPUT_GAMEPAD get_state()
+            {
+                ZeroMemory(&xinput, sizeof(XINPUT_STATE));
+
+                XInputGetState(id, &xinput);
+
+                return xinput.Gamepad;
+            }
+
+            void set_rumble( const float &left01, const float &right01 )
+            {
+                assert( left01 >= 0.f && left01 <= 1.f );
+                assert( right01 >= 0.f && right01 <= 1.f );
+
+                //if(!is_ready()) return;
+
+                XINPUT_VIBRATION vibration_state;
+                ZeroMemory( &vibration_state, sizeof( XINPUT_VIBRATION ) );
+
+                vibration_state.wLeftMotorSpeed  = DWORD(  left01 * 65535.f );
+                vibration_state.wRightMotorSpeed = DWORD( right01 * 65535.f );
+
+                XInputSetState( id, &vibration_state );
+            }
+
+            public:
+
+            // frozen copy of the shared state, ie, snapshot()->a.hold(). copied at most once per
+            // update(), and only if asked for. the way to read from threads other than the one
+            // updating the master (see sharing_policy)
+            std::shared_ptr< const state > snapshot() const
+            {
+                return sharing_policy::snapshot( *this, id );
+            }
+
+            void clear()
+            {
+                sharing_policy::writer< gamepad > write( *this, id );
+
+                a.clear();
+                b.clear();
+                x.clear();
+                y.clear();
+                back.clear();
+                start.clear();
+                lb.clear();
+                rb.clear();
+                lthumb.clear();
+                rthumb.clear();
+                ltrigger.clear();
+                rtrigger.clear();
+                pad.clear();
+                lpad.clear();
+                rpad.clear();
+                mic.clear();
+                is_ready.clear();
+
+                for( auto &it : earphones )
+                    it.clear();
+
+                for( auto &it : keymap )
+                    it.clear();
+
+                for( auto &it : rumble )
+                    it.clear();
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                // slaves read the master's state: nothing to do
+                if( !sharing_policy::is_master( *this, id ) )
+                    return;
+
+                sharing_policy::writer< gamepad > write( *this, id );
+
+                if( !GetFocus() )
+                {
+                    if( GetForegroundWindow() != GetConsoleWindow() )
+                    {
+                        clear();
+                        return;
+                    }
+                }
+
+                ZeroMemory(&xinput, sizeof(XINPUT_STATE));
+                bool is_present = ( XInputGetState( id, &xinput ) == ERROR_SUCCESS );
+
+                is_ready.set( is_present );
+
+                if( !is_present )
+                    return;
+
+                // read device
+                XINPUT_GAMEPAD state = get_state();
+
+                // process inputs : buttons
+
+                     a.set( state.wButtons &              XINPUT_GAMEPAD_A ? 1.0f : 0.f );
+                     b.set( state.wButtons &              XINPUT_GAMEPAD_B ? 1.0f : 0.f );
+                     x.set( state.wButtons &              XINPUT_GAMEPAD_X ? 1.0f : 0.f );
                      y.set( state.wButtons &              XINPUT_GAMEPAD_Y ? 1.0f : 0.f );
                   back.set( state.wButtons &           XINPUT_GAMEPAD_BACK ? 1.0f : 0.f );
                  start.set( state.wButtons &          XINPUT_GAMEPAD_START ? 1.0f : 0.f );
@@ -1139,819 +4806,1796 @@ namespace hyde
                 lthumb.set( state.wButtons &     XINPUT_GAMEPAD_LEFT_THUMB ? 1.0f : 0.f );
                 rthumb.set( state.wButtons &    XINPUT_GAMEPAD_RIGHT_THUMB ? 1.0f : 0.f );
 
-                // process inputs : triggers
+                // process inputs : triggers
+
+                ltrigger.set( state.bLeftTrigger / 255.0 );
+                rtrigger.set( state.bRightTrigger / 255.0 );
+
+                // process inputs : digital pad
+
+                float padUp    = ( state.wButtons &    XINPUT_GAMEPAD_DPAD_UP ? 1.0f : 0.f );
+                float padDown  = ( state.wButtons &  XINPUT_GAMEPAD_DPAD_DOWN ? 1.0f : 0.f );
+                float padLeft  = ( state.wButtons &  XINPUT_GAMEPAD_DPAD_LEFT ? 1.0f : 0.f );
+                float padRight = ( state.wButtons & XINPUT_GAMEPAD_DPAD_RIGHT ? 1.0f : 0.f );
+                pad.set( - padLeft + padRight, + padUp - padDown );
+
+                // process inputs : thumb pads
+
+                float thumbLX = state.sThumbLX / ( state.sThumbLX > 0 ? 32767.0 : 32768.0 );
+                float thumbLY = state.sThumbLY / ( state.sThumbLY > 0 ? 32767.0 : 32768.0 );
+                float thumbRX = state.sThumbRX / ( state.sThumbRX > 0 ? 32767.0 : 32768.0 );
+                float thumbRY = state.sThumbRY / ( state.sThumbRY > 0 ? 32767.0 : 32768.0 );
+                lpad.set( thumbLX, thumbLY );
+                rpad.set( thumbRX, thumbRY );
+
+                // process outputs : rumble
+
+                set_rumble( rumble[0].newest().x, rumble[1].newest().x );
+
+                /*
+                // process virtual buttons
+
+                brake.set( pad.bLeftTrigger / 255.0 );
+
+                thrust.set( pad.bRightTrigger / 255.0 );
+
+                float thumbLX = pad.sThumbLX / ( pad.sThumbLX > 0 ? 32767.0 : 32768.0 );
+                turn.set( thumbLX );
+                */
+            }
+
+            /*
+            void test()
+            {
+                if( earphones.isReady() )
+                {
+                    std::vector< vec2 > soundSample;
+                    earphones << soundSample;
+
+                    vec2 soundSample2[500];
+                    earphones << 500 << soundSample2;
+                }
+
+                if( rumble.isReady() )
+                {
+                    rumble << vec2( 1, 1 );
+                }
+
+                if( axis.isReady() )
+                {
+                    vec2 current;
+                    //axis[0] >> current;
+
+                    if( current.x > 0.5f ) 0;
+                    if( current.y > 0.5f ) 0;
+                    if( current.magnitude() > 0.5f ) 0;
+
+                    std::vector<vec2> last_4_samples(4);
+                    //axis[0] >> 4 >> last_4_samples;
+                }
+
+                if( keys.isReady() )
+                {
+                    //
+                    // ...
+                }
+
+                if( mic.isReady() )
+                {
+                    std::vector<vec1> recording( 300 ); //300 muestras
+                    mic >> 300 >> recording;
+                }
+
+                // encuentra patterns en el buffer de datas y devuelve probabilidad
+
+                //if peak in last 0.10 seconds in cross is at least 80% found then...
+                if( hid::peak( axis[0], 0.10f ) > 0.80f )
+                {}
+
+                if( hid::sustain( axis[0], 0.25f ) > 0.50f )
+                {}
+
+                vec2 hadoken[3] = { vec2(0,1),vec2(1,1),vec2(1,0) };
+                if( hid::stroke( axis[0], 0.25f, 3, hadoken ) > 0.85f )
+                {}
+            }
+            */
+        };
+    }
+
+    namespace windows
+    {
+
+        class keyboard //, public hyde::enums::keyboard
+        {
+            DWORD id;
+
+        public:
+
+            // everything polled, shared by every keyboard of the same id (see sharing_policy)
+            struct state
+            {
+                hyde::buttons keymap;
+                hyde::serializers serial;
+                hyde::button debug_key;
+                hyde::flag is_ready;
+                hyde::keyplane keystate;
+
+                state() : keymap( 256 ), serial( 1 )
+                {
+                    // same timestamp for keystate and every key, so bulk and per-key queries agree.
+                    // a local tick, not a frame: devices may be built on any thread
+                    hid::tick now = global_timer.now();
+
+                    keystate.reset( now );
+
+                    for( auto &it : keymap )
+                    {
+                        it.clear( now );
+                        it.age_from( &keystate.polls() );
+                    }
+                }
+
+                // copies age from their own keystate
+                state( const state &other ) :
+                    keymap( other.keymap ), serial( other.serial ), debug_key( other.debug_key ),
+                    is_ready( other.is_ready ), keystate( other.keystate )
+                {
+                    for( auto &it : keymap )
+                        it.age_from( &keystate.polls() );
+                }
+            };
+
+        protected:
+
+            state &shared;
+
+            keyboard( const keyboard & );
+            keyboard &operator =( const keyboard & );
+
+        public:
+
+            // we are implementing keyboard from two sides:
+            // - an input serial data (able to send strings to app)
+            // - a 105 input button map (so we can query each key status individually)
+
+            const char *const typeof;
+
+            hyde::buttons &keymap;
+            hyde::serializers &serial;
+
+            /* sorry about the long reference memberlist :) */
+            hyde::button &a, &b, &c, &d, &e, &f, &g, &h, &i, &j, &k, &l,
+                &m, &n, &o, &p, &q, &r, &s, &t, &u, &v, &w, &x, &y, &z,
+                &one, &two, &three, &four, &five, &six, &seven, &eight, &nine, &zero,
+                &escape, &backspace, &tab, &enter, &shift, &ctrl, &alt, &space,
+                &up, &down, &left, &right, &home, &end, &insert, &del,
+                &f1, &f2, &f3, &f4, &f5, &f6, &f7, &f8, &f9, &f10, &f11, &f12,
+                &numpad1, &numpad2, &numpad3, &numpad4, &numpad5,
+                &numpad6, &numpad7, &numpad8, &numpad9, &numpad0,
+                &add, &subtract, &multiply, &divide, &separator, &decimal;
+
+            hyde::button &debug_key;
+
+            hyde::flag &is_ready; //is_connected
+
+            // state of the 256 virtual keys at last poll, for bulk queries, ie:
+            //   if( kb.keystate.trigger().any() ) ...
+            // keymap histories age lazily from keystate.polls() (see history::age_from())
+            hyde::keyplane &keystate;
+
+            keyboard( const unsigned &_id )
+#if 1
+            :
+#else
+            try :
+#endif
+                              id(_id),
+                  shared( sharing_policy::attach( *this, _id ) ),
+                  typeof("hyde::windows::keyboard"),
+                     keymap( shared.keymap ), serial( shared.serial ),
+                   a( keymap[ hyde::keycode::A ] ),
+                   b( keymap[ hyde::keycode::B ] ),
+                   c( keymap[ hyde::keycode::C ] ),
+                   d( keymap[ hyde::keycode::D ] ),
+                   e( keymap[ hyde::keycode::E ] ),
+                   f( keymap[ hyde::keycode::F ] ),
+                   g( keymap[ hyde::keycode::G ] ),
+                   h( keymap[ hyde::keycode::H ] ),
+                   i( keymap[ hyde::keycode::I ] ),
+                   j( keymap[ hyde::keycode::J ] ),
+                   k( keymap[ hyde::keycode::K ] ),
+                   l( keymap[ hyde::keycode::L ] ),
+                   m( keymap[ hyde::keycode::M ] ),
+                   n( keymap[ hyde::keycode::N ] ),
+                   o( keymap[ hyde::keycode::O ] ),
+                   p( keymap[ hyde::keycode::P ] ),
+                   q( keymap[ hyde::keycode::Q ] ),
+                   r( keymap[ hyde::keycode::R ] ),
+                   s( keymap[ hyde::keycode::S ] ),
+                   t( keymap[ hyde::keycode::T ] ),
+                   u( keymap[ hyde::keycode::U ] ),
+                   v( keymap[ hyde::keycode::V ] ),
+                   w( keymap[ hyde::keycode::W ] ),
+                   x( keymap[ hyde::keycode::X ] ),
+                   y( keymap[ hyde::keycode::Y ] ),
+                   z( keymap[ hyde::keycode::Z ] ),
+                 one( keymap[ hyde::keycode::ONE ] ),
+                 two( keymap[ hyde::keycode::TWO ] ),
+               three( keymap[ hyde::keycode::THREE ] ),
+                four( keymap[ hyde::keycode::FOUR ] ),
+                five( keymap[ hyde::keycode::FIVE ] ),
+                 six( keymap[ hyde::keycode::SIX ] ),
+               seven( keymap[ hyde::keycode::SEVEN ] ),
+               eight( keymap[ hyde::keycode::EIGHT ] ),
+                nine( keymap[ hyde::keycode::NINE ] ),
+                zero( keymap[ hyde::keycode::ZERO ] ),
+              escape( keymap[ hyde::keycode::ESCAPE ] ),
+           backspace( keymap[ hyde::keycode::BACKSPACE ] ),
+                 tab( keymap[ hyde::keycode::TAB ] ),
+               enter( keymap[ hyde::keycode::ENTER ] ),
+               shift( keymap[ hyde::keycode::SHIFT ] ),
+                ctrl( keymap[ hyde::keycode::CTRL ] ),
+                 alt( keymap[ hyde::keycode::ALT ] ),
+               space( keymap[ hyde::keycode::SPACE ] ),
+                  up( keymap[ hyde::keycode::UP ] ),
+                down( keymap[ hyde::keycode::DOWN ] ),
+                left( keymap[ hyde::keycode::LEFT ] ),
+               right( keymap[ hyde::keycode::RIGHT ] ),
+                home( keymap[ hyde::keycode::HOME ] ),
+                 end( keymap[ hyde::keycode::END ] ),
+              insert( keymap[ hyde::keycode::INSERT ] ),
+                 del( keymap[ hyde::keycode::DEL ] ),
+                  f1( keymap[ hyde::keycode::F1 ] ),
+                  f2( keymap[ hyde::keycode::F2 ] ),
+                  f3( keymap[ hyde::keycode::F3 ] ),
+                  f4( keymap[ hyde::keycode::F4 ] ),
+                  f5( keymap[ hyde::keycode::F5 ] ),
+                  f6( keymap[ hyde::keycode::F6 ] ),
+                  f7( keymap[ hyde::keycode::F7 ] ),
+                  f8( keymap[ hyde::keycode::F8 ] ),
+                  f9( keymap[ hyde::keycode::F9 ] ),
+                 f10( keymap[ hyde::keycode::F10 ] ),
+                 f11( keymap[ hyde::keycode::F11 ] ),
+                 f12( keymap[ hyde::keycode::F12 ] ),
+             numpad1( keymap[ hyde::keycode::NUMPAD1 ] ),
+             numpad2( keymap[ hyde::keycode::NUMPAD2 ] ),
+             numpad3( keymap[ hyde::keycode::NUMPAD3 ] ),
+             numpad4( keymap[ hyde::keycode::NUMPAD4 ] ),
+             numpad5( keymap[ hyde::keycode::NUMPAD5 ] ),
+             numpad6( keymap[ hyde::keycode::NUMPAD6 ] ),
+             numpad7( keymap[ hyde::keycode::NUMPAD7 ] ),
+             numpad8( keymap[ hyde::keycode::NUMPAD8 ] ),
+             numpad9( keymap[ hyde::keycode::NUMPAD9 ] ),
+             numpad0( keymap[ hyde::keycode::NUMPAD0 ] ),
+                 add( keymap[ hyde::keycode::ADD ] ),
+            subtract( keymap[ hyde::keycode::SUBTRACT ] ),
+            multiply( keymap[ hyde::keycode::MULTIPLY ] ),
+              divide( keymap[ hyde::keycode::DIVIDE ] ),
+           separator( keymap[ hyde::keycode::SEPARATOR ] ),
+             decimal( keymap[ hyde::keycode::DECIMAL ] ),
+           debug_key( shared.debug_key ),
+            is_ready( shared.is_ready ),
+            keystate( shared.keystate )
+            {
+                if( id >= max_devices )
+                {
+                    std::cerr << "error: device id #" << id << " invalid! (seen at " << typeof << " controller)" << std::endl;
+                    assert( false );
+                    return;
+                }
+            }
+#if 0
+            catch(...)
+            {
+                throw "";
+            }
+#endif
+
+            ~keyboard()
+            {
+                if( sharing_policy::owns( *this, id ) )
+                {
+                    // remove pending keystrokes
+
+                    std::cin.clear();
+                    //std::cin.ignore(std::numeric_limits<std::streamsize>::max());
+                }
+
+                sharing_policy::detach( *this, id );
+            }
+
+            static const size_t max_devices = 1;
+
+            // frozen copy of the shared state, see windows::gamepad::snapshot()
+            std::shared_ptr< const state > snapshot() const
+            {
+                return sharing_policy::snapshot( *this, id );
+            }
+
+            void clear()
+            {
+                sharing_policy::writer< keyboard > write( *this, id );
+
+                hid::tick now = global_timer.now();
+
+                keystate.reset( now );
+
+                for( auto &it : keymap )
+                    it.clear( now );
+
+                for( auto &it : serial )
+                    it.clear();
+
+                debug_key.clear();
+                is_ready.clear();
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                // slaves read the master's state: nothing to do
+                if( !sharing_policy::is_master( *this, id ) )
+                {
+                    return;
+                    /*
+            hyde::button &a, &b, &c, &d, &e, &f, &g, &h, &i, &j, &k, &l,
+                &m, &n, &o, &p, &q, &r, &s, &t, &u, &v, &w, &x, &y, &z,
+                &one, &two, &three, &four, &five, &six, &seven, &eight, &nine, &zero,
+                &escape, &backspace, &tab, &enter, &shift, &ctrl, &space,
+                &up, &down, &left, &right, &home, &end, &insert, &del,
+                &f1, &f2, &f3, &f4, &f5, &f6, &f7, &f8, &f9, &f10, &f11, &f12,
+                &numpad1, &numpad2, &numpad3, &numpad4, &numpad5,
+                &numpad6, &numpad7, &numpad8, &numpad9, &numpad0,
+                &add, &subtract, &multiply, &divide, &separator, &decimal;
+                */
+                }
+
+                sharing_policy::writer< keyboard > write( *this, id );
+
+				if( !GetFocus() )
+                {
+                    if( GetForegroundWindow() != GetConsoleWindow() )
+                    {
+                        clear();
+                        return;
+                    }
+                }
+                else
+                {
+                    MSG m;
+                    while( PeekMessage( &m, NULL, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE ) )
+                        ;
+                }
+
+                bool is_connected = true;
+
+                // to check: http://molecularmusings.wordpress.com/2011/09/05/properly-handling-keyboard-input/
+
+                /*
+                return ( GetFocus() != 0 );
+
+                static HWND myWnd;
+                static struct install { install() {
+                    HWND prevWnd;
+                    myWnd = SetCapture( prevWnd = GetCapture() );
+                    //GetWindowThreadProcessId( myWnd, &myProc );
+                    ReleaseCapture();
+                } } _;
+                return GetForegroundWindow() == myWnd;
+                */
+
+                is_ready.set( is_connected );
+
+                if( !is_connected )
+                    return;
+
+                //GetKeyboardState( (PBYTE)&keymap ) )
+
+                hyde::keybits now;
+
+                for( int i = 0; i < 256; ++i )
+                {
+                    SHORT key = GetAsyncKeyState( i );
+                    now.set( i, ( key & 0x8000 ) != 0 );
+
+                    //if( key ) serializer << ch; // y q pasa con el cero?
+                }
+
+                // only flipped keys get a new sample; the rest age lazily from keystate
+                keystate.update( now, global_timer.now() ).for_each( [&]( size_t i ) {
+                    keymap[ i ].set( now.test( i ) ? 0.5f : 0.f );
+                } );
+            }
+        };
+
+
+        class mouse //, public hyde::enums::mouse
+        {
+            size_t id;
+
+            public:
+
+            enum button_enumeration
+            {
+                LEFT,
+                MIDDLE,
+                RIGHT
+            };
+
+            enum flag_enumeration
+            {
+                HOVER,
+                CONNECTED,
+                HIDDEN,
+                CLIPPED,
+                CENTERED
+            };
+
+            enum axis_enumeration
+            {
+                WHEEL,
+                LOCAL,		// app (dt,dt) center = (0,0)
+                GLOBAL,		// desktop (x,y)
+                CLIENT,		// app (x,y)
+                DESKTOP,	// desktop (dt,dt) center = (0,0)
+                MOTION		// accumulated raw relative motion (x,y), in device counts
+            };
+
+            // everything polled, shared by every mouse of the same id (see sharing_policy)
+            struct state
+            {
+                hyde::flags flags;
+                hyde::buttons buttons;
+                hyde::coordinates coordinates;
+
+                // raw relative motion is summed into one motion sample per poll (see motion_coalescer)
+                hyde::motion_coalescer coalescing;
+
+                // latency is only sampled for events with a ManyMouseEvent::timestamp
+                hyde::input_stats counters;
+
+                // motion is the running sum of relative counts, wheel the running sum of notches
+                int mx, my;
+                float dx, dy;
+
+                // buttons are only set on events, and age lazily from here (see history::age_from())
+                hid::polls polled;
+
+                state() : flags( 5 ), buttons( 3 ), coordinates( 6 ), mx( 0 ), my( 0 ), dx( 0 ), dy( 0 ),
+                    polled( global_timer.now() )
+                {
+                    for( auto &it : buttons )
+                        it.age_from( &polled );
+                }
+
+                // copies age from their own polls
+                state( const state &other ) :
+                    flags( other.flags ), buttons( other.buttons ), coordinates( other.coordinates ),
+                    coalescing( other.coalescing ), counters( other.counters ),
+                    mx( other.mx ), my( other.my ), dx( other.dx ), dy( other.dy ), polled( other.polled )
+                {
+                    for( auto &it : buttons )
+                        it.age_from( &polled );
+                }
+            };
+
+        protected:
+
+            state &shared;
+
+            mouse( const mouse & );
+            mouse &operator =( const mouse & );
+
+        public:
+
+            // como hago la memoization?
+            // q es mejor:
+            // - leo las entradas, y cada vez que me preguntan un combo compruebo todas las combinaciones?
+            //   combo["punch"]? : return (if A[0].hold() && A[1].hold() && A[2].hold() && B[3].tap() ? true : false)
+            // - o con cada entrada que leo sigo todas las maquinas de estados vivas, y actualizo valores de retorno
+            //   para cuando me consulten?
+            //   read pad -> A -> fsm #1 -> step3/13 -> combo["punch"] = false;
+            //                    fsm #2 -> step19/19 -> "kick" -> combo["kick"] = true;
+            // - hago un map<string,val> cache; y lo limpio/lleno en cada update?
+
+            hyde::flags &flags;
+            hyde::buttons &buttons;
+            hyde::coordinates &coordinates;
+
+            hyde::button &left, &middle, &right;
+            hyde::coordinate &wheel, &local, &global, &client, &desktop, &motion;
+            hyde::flag &hover, &connected, &hidden, &clipped, &centered;
+
+            hyde::motion_coalescer &coalescing;
+            hyde::input_stats &counters;
+
+        protected:
+            int ix, iy;
+            bool check_console_window;
+
+        public:
+                 mouse( const size_t &_id, bool check_console_window = false ) :
+                    id(_id), shared( sharing_policy::attach( *this, _id ) ), ix(0), iy(0),
+              flags( shared.flags ), buttons( shared.buttons ), coordinates( shared.coordinates ),
+                    left( buttons[ LEFT ] ),
+                  middle( buttons[ MIDDLE ] ),
+                   right( buttons[ RIGHT ] ),
+                   wheel( coordinates[ WHEEL ] ),
+                   local( coordinates[ LOCAL ] ),
+                  global( coordinates[ GLOBAL ] ),
+                  client( coordinates[ CLIENT ]),
+                 desktop( coordinates[ DESKTOP ] ),
+                  motion( coordinates[ MOTION ] ),
+                   hover( flags[ HOVER ] ),
+               connected( flags[ CONNECTED ] ),
+                  hidden( flags[ HIDDEN ] ),
+                 clipped( flags[ CLIPPED ] ),
+                centered( flags[ CENTERED ]),
+              coalescing( shared.coalescing ),
+                counters( shared.counters ),
+               typeof( "hyde::windows::mouse" ),
+          check_console_window( check_console_window )
+            {
+                if( id >= max_devices )
+                {
+                    std::cerr << "error: device id #" << id << " invalid! (seen at " << typeof << " controller)" << std::endl;
+                    assert( false );
+                    return;
+                }
+                //
+                // caps = hyde::caps( max_devices, max_instances_per_device );
+            }
+
+            ~mouse()
+            {
+                sharing_policy::detach( *this, id );
+            }
+
+            static const size_t max_devices = 1;
+
+            const char *const typeof;
+
+            // frozen copy of the shared state, see windows::gamepad::snapshot()
+            std::shared_ptr< const state > snapshot() const
+            {
+                return sharing_policy::snapshot( *this, id );
+            }
+
+            void clear()
+            {
+                sharing_policy::writer< mouse > write( *this, id );
+
+                for( auto &it : buttons )
+                    it.clear();
+                for( auto &it : coordinates )
+                    it.clear();
+                for( auto &it : flags )
+                    it.clear();
+
+                shared.polled = hid::polls( global_timer.now() );
+            }
+
+            // latency and event counters, see hyde::input_stats. coalesced and dropped events are
+            // counted by manymouse's queue, for all mice
+            input_stats stats() const
+            {
+                ManyMouseQueueStats queue;
+                ManyMouse_GetQueueStats( &queue );
+
+                input_stats out = counters;
+                out.coalesced = queue.coalesced + coalescing.events() - coalescing.samples();
+                out.dropped = queue.dropped;
+                return out;
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                // slaves read the master's state: nothing to do
+                if( !sharing_policy::is_master( *this, id ) )
+                    return;
+
+                sharing_policy::writer< mouse > write( *this, id );
+
+#if 1
+
+                if( !GetFocus() )
+                {
+                    if( GetForegroundWindow() != GetConsoleWindow() )
+                    {
+                        clear();
+                        return;
+                    }
+                }
+                else
+                {
+                    MSG m;
+                    while( PeekMessage( &m, NULL, WM_MOUSEFIRST, WM_MOUSELAST, PM_REMOVE ) )
+                        ;
+                }
+
+                // @todo: replace is_present with a proper/reliable is_present() function
+
+                static HWND parentWnd = 0;
+                static bool is_mouse_present = true;
+                static HCURSOR default_cursor;
+                static HCURSOR hidden_cursor;
+                static HICON hicon;
+
+                static struct detection_setup {
+                    detection_setup() {
+                        HWND prevWnd; parentWnd = SetCapture( prevWnd = GetCapture() ); //ReleaseCapture();
+                        is_mouse_present = ShowCursor( true ) >= 0;
+                        default_cursor = LoadCursor(0, IDC_ARROW);
+
+                         // make hidden_cursor transparent
+
+                        int w = GetSystemMetrics( SM_CXCURSOR );
+                        int h = GetSystemMetrics( SM_CYCURSOR );
+
+                        std::vector<unsigned char> and_mask( w * h, 0xFF );
+                        std::vector<unsigned char> xor_mask( w * h, 0x00 );
+
+                        hidden_cursor = CreateCursor(
+                          0,
+                          1,
+                          1,
+                          w,
+                          h,
+                          &and_mask[0],
+                          &xor_mask[0]
+                        );
+
+                        BYTE ANDmaskIcon[] = {0xFF, 0xFF, 0xFF, 0xFF,  // line 1
+                                              0xFF, 0xFF, 0xC3, 0xFF,  // line 2
+                                              0xFF, 0xFF, 0x00, 0xFF,  // line 3
+                                              0xFF, 0xFE, 0x00, 0x7F,  // line 4
+
+                                              0xFF, 0xFC, 0x00, 0x1F,  // line 5
+                                              0xFF, 0xF8, 0x00, 0x0F,  // line 6
+                                              0xFF, 0xF8, 0x00, 0x0F,  // line 7
+                                              0xFF, 0xF0, 0x00, 0x07,  // line 8
+
+                                              0xFF, 0xF0, 0x00, 0x03,  // line 9
+                                              0xFF, 0xE0, 0x00, 0x03,  // line 10
+                                              0xFF, 0xE0, 0x00, 0x01,  // line 11
+                                              0xFF, 0xE0, 0x00, 0x01,  // line 12
+
+                                              0xFF, 0xF0, 0x00, 0x01,  // line 13
+                                              0xFF, 0xF0, 0x00, 0x00,  // line 14
+                                              0xFF, 0xF8, 0x00, 0x00,  // line 15
+                                              0xFF, 0xFC, 0x00, 0x00,  // line 16
+
+                                              0xFF, 0xFF, 0x00, 0x00,  // line 17
+                                              0xFF, 0xFF, 0x80, 0x00,  // line 18
+                                              0xFF, 0xFF, 0xE0, 0x00,  // line 19
+                                              0xFF, 0xFF, 0xE0, 0x01,  // line 20
+
+                                              0xFF, 0xFF, 0xF0, 0x01,  // line 21
+                                              0xFF, 0xFF, 0xF0, 0x01,  // line 22
+                                              0xFF, 0xFF, 0xF0, 0x03,  // line 23
+                                              0xFF, 0xFF, 0xE0, 0x03,  // line 24
 
-                ltrigger.set( state.bLeftTrigger / 255.0 );
-                rtrigger.set( state.bRightTrigger / 255.0 );
+                                              0xFF, 0xFF, 0xE0, 0x07,  // line 25
+                                              0xFF, 0xFF, 0xC0, 0x0F,  // line 26
+                                              0xFF, 0xFF, 0xC0, 0x0F,  // line 27
+                                              0xFF, 0xFF, 0x80, 0x1F,  // line 28
 
-                // process inputs : digital pad
+                                              0xFF, 0xFF, 0x00, 0x7F,  // line 29
+                                              0xFF, 0xFC, 0x00, 0xFF,  // line 30
+                                              0xFF, 0xF8, 0x03, 0xFF,  // line 31
+                                              0xFF, 0xFC, 0x3F, 0xFF}; // line 32
 
-                float padUp    = ( state.wButtons &    XINPUT_GAMEPAD_DPAD_UP ? 1.0f : 0.f );
-                float padDown  = ( state.wButtons &  XINPUT_GAMEPAD_DPAD_DOWN ? 1.0f : 0.f );
-                float padLeft  = ( state.wButtons &  XINPUT_GAMEPAD_DPAD_LEFT ? 1.0f : 0.f );
-                float padRight = ( state.wButtons & XINPUT_GAMEPAD_DPAD_RIGHT ? 1.0f : 0.f );
-                pad.set( - padLeft + padRight, + padUp - padDown );
+                        // Yang-shaped icon XOR mask
 
-                // process inputs : thumb pads
+                        BYTE XORmaskIcon[] = {0x00, 0x00, 0x00, 0x00,  // line 1
+                                              0x00, 0x00, 0x00, 0x00,  // line 2
+                                              0x00, 0x00, 0x00, 0x00,  // line 3
+                                              0x00, 0x00, 0x00, 0x00,  // line 4
 
-                float thumbLX = state.sThumbLX / ( state.sThumbLX > 0 ? 32767.0 : 32768.0 );
-                float thumbLY = state.sThumbLY / ( state.sThumbLY > 0 ? 32767.0 : 32768.0 );
-                float thumbRX = state.sThumbRX / ( state.sThumbRX > 0 ? 32767.0 : 32768.0 );
-                float thumbRY = state.sThumbRY / ( state.sThumbRY > 0 ? 32767.0 : 32768.0 );
-                lpad.set( thumbLX, thumbLY );
-                rpad.set( thumbRX, thumbRY );
+                                              0x00, 0x00, 0x00, 0x00,  // line 5
+                                              0x00, 0x00, 0x00, 0x00,  // line 6
+                                              0x00, 0x00, 0x00, 0x00,  // line 7
+                                              0x00, 0x00, 0x38, 0x00,  // line 8
 
-                // process outputs : rumble
+                                              0x00, 0x00, 0x7C, 0x00,  // line 9
+                                              0x00, 0x00, 0x7C, 0x00,  // line 10
+                                              0x00, 0x00, 0x7C, 0x00,  // line 11
+                                              0x00, 0x00, 0x38, 0x00,  // line 12
 
-                set_rumble( rumble[0].newest().x, rumble[1].newest().x );
+                                              0x00, 0x00, 0x00, 0x00,  // line 13
+                                              0x00, 0x00, 0x00, 0x00,  // line 14
+                                              0x00, 0x00, 0x00, 0x00,  // line 15
+                                              0x00, 0x00, 0x00, 0x00,  // line 16
 
-                /*
-                // process virtual buttons
+                                              0x00, 0x00, 0x00, 0x00,  // line 17
+                                              0x00, 0x00, 0x00, 0x00,  // line 18
+                                              0x00, 0x00, 0x00, 0x00,  // line 19
+                                              0x00, 0x00, 0x00, 0x00,  // line 20
 
-                brake.set( pad.bLeftTrigger / 255.0 );
+                                              0x00, 0x00, 0x00, 0x00,  // line 21
+                                              0x00, 0x00, 0x00, 0x00,  // line 22
+                                              0x00, 0x00, 0x00, 0x00,  // line 23
+                                              0x00, 0x00, 0x00, 0x00,  // line 24
 
-                thrust.set( pad.bRightTrigger / 255.0 );
+                                              0x00, 0x00, 0x00, 0x00,  // line 25
+                                              0x00, 0x00, 0x00, 0x00,  // line 26
+                                              0x00, 0x00, 0x00, 0x00,  // line 27
+                                              0x00, 0x00, 0x00, 0x00,  // line 28
 
-                float thumbLX = pad.sThumbLX / ( pad.sThumbLX > 0 ? 32767.0 : 32768.0 );
-                turn.set( thumbLX );
-                */
-            }
+                                              0x00, 0x00, 0x00, 0x00,  // line 29
+                                              0x00, 0x00, 0x00, 0x00,  // line 30
+                                              0x00, 0x00, 0x00, 0x00,  // line 31
+                                              0x00, 0x00, 0x00, 0x00}; // line 32
 
-            /*
-            void test()
-            {
-                if( earphones.isReady() )
+                        HINSTANCE hInstance = (HINSTANCE)GetModuleHandle(NULL);
+
+                        hicon  = CreateIcon(hInstance, // handle to app. instance
+                                     32,               // icon width
+                                     32,               // icon height
+                                     1,                // number of XOR planes
+                                     1,                // number of bits per pixel
+                                     ANDmaskIcon,      // AND mask
+                                     XORmaskIcon);     // XOR mask
+                    }
+                    ~detection_setup() {
+                        ReleaseCapture();
+                        SetCursor(default_cursor);
+                        DestroyCursor(hidden_cursor);
+                    }}_;
+
+                connected.set( is_mouse_present ? 0.5f : 0.f );
+
+                if( !is_mouse_present )
                 {
-                    std::vector< vec2 > soundSample;
-                    earphones << soundSample;
+                    shared.polled.advance( global_timer.now() );
+                    return;
+                }
 
-                    vec2 soundSample2[500];
-                    earphones << 500 << soundSample2;
+                // process outputs 1/3
+
+                //SetClassLong( hWnd, GCL_HCURSOR, (LONG)( default_cursor ) );
+
+                // process inputs (buttons come with manymouse events, below)
+
+                bool is_hover = false;
+
+                CURSORINFO ci;
+                ci.cbSize = sizeof(CURSORINFO);
+
+                // disable clipping
+                ClipCursor( 0 );
+
+                if( GetCursorInfo( &ci ) )
+                {
+                    POINT pPoint = ci.ptScreenPos;
+
+                    // set virtual screen coordinates in normalised [-1,+1]x[-1,+1] form whose center is (0,0)
+                    {
+                        float gx, gy;
+
+                        gx = -1.0f + float(pPoint.x+pPoint.x) / float( GetSystemMetrics( SM_CXVIRTUALSCREEN ) );
+                        gy =  1.0f - float(pPoint.y+pPoint.y) / float( GetSystemMetrics( SM_CYVIRTUALSCREEN ) );
+
+                        desktop.set( pPoint.x, pPoint.y );
+                        global.set( gx, gy );
+                    }
+
+                    HWND hWnd = WindowFromPoint( pPoint );
+
+                    // if [ parent window, console window, or kind-of-subchild ] then...
+                    if( hWnd == parentWnd || (hWnd == GetConsoleWindow() && check_console_window) || GetWindowLongPtr(hWnd, GWLP_WNDPROC) )
+                    {
+                        // point inside any of our windows
+                        is_hover = true;
+
+                        // transform point into window->client rect coordinates
+                        WINDOWINFO wi;
+                        wi.cbSize=sizeof(WINDOWINFO);
+                        GetWindowInfo(hWnd, &wi);
+
+                        if( centered.hold() )
+                        {
+                            int cx = ( wi.rcClient.right - wi.rcClient.left ) / 2 + wi.rcClient.left;
+                            int cy = ( wi.rcClient.bottom - wi.rcClient.top ) / 2 + wi.rcClient.top;
+
+                            int dx = pPoint.x - cx;
+                            int dy = pPoint.y - cy;
+
+                            SetCursorPos( cx, cy );
+
+                            client.set( ix += dx, iy += dy );
+                        }
+                        else
+                        {
+                            pPoint.x -= wi.rcClient.left;
+                            pPoint.y -= wi.rcClient.top;
+
+                            client.set( ix = pPoint.x, iy = pPoint.y );
+                        }
+
+                        // set coordinate in normalised [-1,+1]x[-1,+1] form whose center is (0,0)
+                        {
+                            float lx, ly;
+
+                            lx = -1.0f + float(pPoint.x+pPoint.x) / float( wi.rcClient.right - wi.rcClient.left );
+                            ly =  1.0f - float(pPoint.y+pPoint.y) / float( wi.rcClient.bottom - wi.rcClient.top + 1 );
+
+                            local.set( lx, ly );
+                        }
+
+                        // process outputs 2/3: enable clipping, if required
+                        if( clipped.hold() ) ClipCursor( &wi.rcClient );
+                    }
+
+                    // process outputs 3/3: hide cursor, if required
+
+                    {
+                        bool hide_request = hidden.hold();
+                        bool show_request = hidden.idle();
+
+                        // method #1
+						if(0)
+                        {
+                            ShowCursor( TRUE );
+                            int counter = ShowCursor( FALSE ); //<0: no mouse installed, or hidden cursor
+
+                            bool visible = (counter >= 0);
+
+                            if( visible )
+                            {
+                                if( hide_request ) while(counter>=0) counter=ShowCursor(FALSE);
+                            }
+                            else
+                            {
+                                if( show_request ) while(counter <0) counter=ShowCursor(TRUE);
+                            }
+                        }
+
+                        // method #2
+						if(0)
+                        SetClassLongPtr( hWnd, GCLP_HCURSOR, (LONG)( show_request ? default_cursor : hidden_cursor ) );
+
+						// method #3
+						if( hide_request ) while( ShowCursor(FALSE) >= 0 ) ;
+						else
+						if( show_request ) while( ShowCursor(TRUE) < 0 ) ;
+                    }
+
+                    // stupid feature:
+
+                    SetClassLongPtr( hWnd, GCLP_HICON, (LONG)(hicon) );
                 }
 
-                if( rumble.isReady() )
-                {
-                    rumble << vec2( 1, 1 );
-                }
+                hover.set( is_hover ? 0.5f : 0.f );
+
+#endif
+
+
+
+
+                static struct once {
+                    once() {
+                        const int num_mice = ManyMouse_Init();
+                        driver = ManyMouse_DriverName();
+                        for( int i = 0; i < num_mice; ++i )
+                        {
+                            drivers.push_back( ManyMouse_DeviceName(i) );
+                        }
+                    }
+                    ~once() {
+                        ManyMouse_Quit();
+                    }
+                    const char *driver;
+                    std::vector<const char *> drivers;
+                } lib;
+
+                    ManyMouseEvent event;
+                    int &mx = shared.mx, &my = shared.my;
+                    float &dx = shared.dx, &dy = shared.dy;
+                    hid::polls &polled = shared.polled;
+
+                    hid::tick now = global_timer.now(), offset = 0;
+
+                    auto emit = [&]( const hid::tick &t, int x, int y ) {
+                        motion.set_at( t, float( mx += x ), float( my += y ) );
+                    };
+
+                    // drain every queued event, not just one per update
+                    while( ManyMouse_PollEvent(&event) )
+                    {
+                        if( event.device != 0 )
+                            continue;
+
+                        // stamped by the driver, if it can (CLOCK_MONOTONIC, as steady_clock)
+                        hid::tick t = now;
+
+                        if( event.timestamp )
+                        {
+                            if( !offset )
+                                offset = global_timer.monotonic_offset();
+
+                            t = (std::min)( hid::tick( event.timestamp ) - offset, now );
+                            counters.latency.add( now - t );
+                        }
+
+                        ++counters.processed;
+
+                        if (event.type == MANYMOUSE_EVENT_RELMOTION )
+                        {
+                            coalescing.add( t, event.item, event.value, emit );
+                        }
+
+                        else if (event.type == MANYMOUSE_EVENT_SCROLL )
+                        {
+                            if( event.item == 0 )
+                            {
+                                dy += ( event.value > 0 ? 1 : -1 ) * 0.100f;
+                            }
+                            else
+                            {
+                                dx += ( event.value > 0 ? 1 : -1 ) * 0.100f;
+                            }
+                        }
+
+                        // buttons are set event by event, flushing pending motion first, so edges
+                        // keep their exact timestamp and position. manymouse numbers them as raw
+                        // input does: 0 left, 1 right, 2 middle
+                        else if (event.type == MANYMOUSE_EVENT_BUTTON )
+                        {
+                            coalescing.flush( emit );
 
-                if( axis.isReady() )
-                {
-                    vec2 current;
-                    //axis[0] >> current;
+                            if( event.item == 0 ) buttons[ LEFT ].set_at( polled.within( t ), event.value ? 0.5f : 0.f );
+                            else
+                            if( event.item == 1 ) buttons[ RIGHT ].set_at( polled.within( t ), event.value ? 0.5f : 0.f );
+                            else
+                            if( event.item == 2 ) buttons[ MIDDLE ].set_at( polled.within( t ), event.value ? 0.5f : 0.f );
+                        }
 
-                    if( current.x > 0.5f ) 0;
-                    if( current.y > 0.5f ) 0;
-                    if( current.magnitude() > 0.5f ) 0;
+#if 0
+                        else if (event.type == MANYMOUSE_EVENT_ABSMOTION )
+                        {
+                            printf("Mouse #%u absolute motion %s %d\n", event.device,
+                                    event.item == 0 ? "X" : "Y", event.value);
+                        }
 
-                    std::vector<vec2> last_4_samples(4);
-                    //axis[0] >> 4 >> last_4_samples;
-                }
+                        else if (event.type == MANYMOUSE_EVENT_DISCONNECT )
+                        {
+                            connected.set( 0.f );
+                        }
 
-                if( keys.isReady() )
-                {
-                    //
-                    // ...
-                }
+                        else
+                        {
+                            // unhandled event.type
+                        }
+#endif
 
-                if( mic.isReady() )
-                {
-                    std::vector<vec1> recording( 300 ); //300 muestras
-                    mic >> 300 >> recording;
-                }
+                    }
 
-                // encuentra patterns en el buffer de datas y devuelve probabilidad
+                    coalescing.flush( emit );
 
-                //if peak in last 0.10 seconds in cross is at least 80% found then...
-                if( hid::peak( axis[0], 0.10f ) > 0.80f )
-                {}
+                    // no raw input (ie, ManyMouse_Init() failed): buttons are polled instead
+                    if( lib.drivers.empty() )
+                    {
+                          left.set( GetAsyncKeyState( VK_LBUTTON ) & 0x8000 ? 0.5f : 0.f );
+                        middle.set( GetAsyncKeyState( VK_MBUTTON ) & 0x8000 ? 0.5f : 0.f );
+                         right.set( GetAsyncKeyState( VK_RBUTTON ) & 0x8000 ? 0.5f : 0.f );
+                    }
 
-                if( hid::sustain( axis[0], 0.25f ) > 0.50f )
-                {}
+                    polled.advance( now );
 
-                vec2 hadoken[3] = { vec2(0,1),vec2(1,1),vec2(1,0) };
-                if( hid::stroke( axis[0], 0.25f, 3, hadoken ) > 0.85f )
-                {}
+                    wheel.set( dx, dy );
             }
-            */
         };
     }
+}
 
-    namespace windows
-    {
 
-        class keyboard //, public hyde::enums::keyboard
-        {
-            DWORD id;
+#endif
 
-        public:
+#ifdef __linux__
 
-            // we are implementing keyboard from two sides:
-            // - an input serial data (able to send strings to app)
-            // - a 105 input button map (so we can query each key status individually)
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <string>
 
-            const char *const typeof;
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/input.h>
 
-            hyde::buttons keymap;
-            hyde::serializers serial;
+namespace hyde
+{
+    namespace linux_evdev
+    {
+        // an evdev node, fifo or recorded file (ie, cat /dev/input/event3 > keyboard.rec),
+        // read as a stream of struct input_event records.
+        //
+        // every open descriptor gets its own copy of the kernel's event stream, so unlike the
+        // windows devices there is no master/slave sharing: each instance reads its own fd.
+        //
+        // events go through a hyde::spsc queue, stamped when read. poll() fills it and
+        // consume() drains it; both run within update(), unless a hyde::input_thread polls.
+        // kernel timestamps ride along (CLOCK_MONOTONIC, when EVIOCSCLOCKID works): samples are
+        // stamped with them, so two clicks read in the same poll are still 5 ms apart, and
+        // stats() can tell how long events took to show up.
 
-            /* sorry about the long reference memberlist :) */
-            hyde::button &a, &b, &c, &d, &e, &f, &g, &h, &i, &j, &k, &l,
-                &m, &n, &o, &p, &q, &r, &s, &t, &u, &v, &w, &x, &y, &z,
-                &one, &two, &three, &four, &five, &six, &seven, &eight, &nine, &zero,
-                &escape, &backspace, &tab, &enter, &shift, &ctrl, &alt, &space,
-                &up, &down, &left, &right, &home, &end, &insert, &del,
-                &f1, &f2, &f3, &f4, &f5, &f6, &f7, &f8, &f9, &f10, &f11, &f12,
-                &numpad1, &numpad2, &numpad3, &numpad4, &numpad5,
-                &numpad6, &numpad7, &numpad8, &numpad9, &numpad0,
-                &add, &subtract, &multiply, &divide, &separator, &decimal;
+        class device
+        {
+            int fd;
+            std::atomic< bool > gone;
+            bool threaded;
 
-            hyde::button debug_key;
+            // kernel timestamps are CLOCK_MONOTONIC, instead of CLOCK_REALTIME
+            bool monotonic;
 
-            hyde::flag is_ready; //is_connected
+            // up to 64 events per read(). records split by pipes wait here for the next read()
+            size_t filled;
+            char buffer[ 64 * sizeof( input_event ) ];
 
-            keyboard *master;
+            hyde::spsc< raw_event > queue;
 
-            keyboard( const unsigned &_id )
-#if 1
-            :
-#else
-            try :
-#endif
-                              id(_id),
-                  typeof("hyde::windows::keyboard"),
-                     keymap( 256 ), serial( 1 ),
-                   a( keymap[ hyde::keycode::A ] ),
-                   b( keymap[ hyde::keycode::B ] ),
-                   c( keymap[ hyde::keycode::C ] ),
-                   d( keymap[ hyde::keycode::D ] ),
-                   e( keymap[ hyde::keycode::E ] ),
-                   f( keymap[ hyde::keycode::F ] ),
-                   g( keymap[ hyde::keycode::G ] ),
-                   h( keymap[ hyde::keycode::H ] ),
-                   i( keymap[ hyde::keycode::I ] ),
-                   j( keymap[ hyde::keycode::J ] ),
-                   k( keymap[ hyde::keycode::K ] ),
-                   l( keymap[ hyde::keycode::L ] ),
-                   m( keymap[ hyde::keycode::M ] ),
-                   n( keymap[ hyde::keycode::N ] ),
-                   o( keymap[ hyde::keycode::O ] ),
-                   p( keymap[ hyde::keycode::P ] ),
-                   q( keymap[ hyde::keycode::Q ] ),
-                   r( keymap[ hyde::keycode::R ] ),
-                   s( keymap[ hyde::keycode::S ] ),
-                   t( keymap[ hyde::keycode::T ] ),
-                   u( keymap[ hyde::keycode::U ] ),
-                   v( keymap[ hyde::keycode::V ] ),
-                   w( keymap[ hyde::keycode::W ] ),
-                   x( keymap[ hyde::keycode::X ] ),
-                   y( keymap[ hyde::keycode::Y ] ),
-                   z( keymap[ hyde::keycode::Z ] ),
-                 one( keymap[ hyde::keycode::ONE ] ),
-                 two( keymap[ hyde::keycode::TWO ] ),
-               three( keymap[ hyde::keycode::THREE ] ),
-                four( keymap[ hyde::keycode::FOUR ] ),
-                five( keymap[ hyde::keycode::FIVE ] ),
-                 six( keymap[ hyde::keycode::SIX ] ),
-               seven( keymap[ hyde::keycode::SEVEN ] ),
-               eight( keymap[ hyde::keycode::EIGHT ] ),
-                nine( keymap[ hyde::keycode::NINE ] ),
-                zero( keymap[ hyde::keycode::ZERO ] ),
-              escape( keymap[ hyde::keycode::ESCAPE ] ),
-           backspace( keymap[ hyde::keycode::BACKSPACE ] ),
-                 tab( keymap[ hyde::keycode::TAB ] ),
-               enter( keymap[ hyde::keycode::ENTER ] ),
-               shift( keymap[ hyde::keycode::SHIFT ] ),
-                ctrl( keymap[ hyde::keycode::CTRL ] ),
-                 alt( keymap[ hyde::keycode::ALT ] ),
-               space( keymap[ hyde::keycode::SPACE ] ),
-                  up( keymap[ hyde::keycode::UP ] ),
-                down( keymap[ hyde::keycode::DOWN ] ),
-                left( keymap[ hyde::keycode::LEFT ] ),
-               right( keymap[ hyde::keycode::RIGHT ] ),
-                home( keymap[ hyde::keycode::HOME ] ),
-                 end( keymap[ hyde::keycode::END ] ),
-              insert( keymap[ hyde::keycode::INSERT ] ),
-                 del( keymap[ hyde::keycode::DEL ] ),
-                  f1( keymap[ hyde::keycode::F1 ] ),
-                  f2( keymap[ hyde::keycode::F2 ] ),
-                  f3( keymap[ hyde::keycode::F3 ] ),
-                  f4( keymap[ hyde::keycode::F4 ] ),
-                  f5( keymap[ hyde::keycode::F5 ] ),
-                  f6( keymap[ hyde::keycode::F6 ] ),
-                  f7( keymap[ hyde::keycode::F7 ] ),
-                  f8( keymap[ hyde::keycode::F8 ] ),
-                  f9( keymap[ hyde::keycode::F9 ] ),
-                 f10( keymap[ hyde::keycode::F10 ] ),
-                 f11( keymap[ hyde::keycode::F11 ] ),
-                 f12( keymap[ hyde::keycode::F12 ] ),
-             numpad1( keymap[ hyde::keycode::NUMPAD1 ] ),
-             numpad2( keymap[ hyde::keycode::NUMPAD2 ] ),
-             numpad3( keymap[ hyde::keycode::NUMPAD3 ] ),
-             numpad4( keymap[ hyde::keycode::NUMPAD4 ] ),
-             numpad5( keymap[ hyde::keycode::NUMPAD5 ] ),
-             numpad6( keymap[ hyde::keycode::NUMPAD6 ] ),
-             numpad7( keymap[ hyde::keycode::NUMPAD7 ] ),
-             numpad8( keymap[ hyde::keycode::NUMPAD8 ] ),
-             numpad9( keymap[ hyde::keycode::NUMPAD9 ] ),
-             numpad0( keymap[ hyde::keycode::NUMPAD0 ] ),
-                 add( keymap[ hyde::keycode::ADD ] ),
-            subtract( keymap[ hyde::keycode::SUBTRACT ] ),
-            multiply( keymap[ hyde::keycode::MULTIPLY ] ),
-              divide( keymap[ hyde::keycode::DIVIDE ] ),
-           separator( keymap[ hyde::keycode::SEPARATOR ] ),
-             decimal( keymap[ hyde::keycode::DECIMAL ] )
+            // owned by the consumer
+            input_stats counters;
+
+            // evdev nodes are opened for writing too when asked for (force feedback), and when
+            // permissions allow. fifos and recorded files are only ever read
+            static int open_node( const std::string &path, bool writable )
             {
-                if( id >= max_devices )
+                struct stat info;
+
+                if( writable && stat( path.c_str(), &info ) == 0 && S_ISCHR( info.st_mode ) )
                 {
-                    std::cerr << "error: device id #" << id << " invalid! (seen at " << typeof << " controller)" << std::endl;
-                    assert( false );
-                    return;
+                    int rw = open( path.c_str(), O_RDWR | O_NONBLOCK );
+
+                    if( rw >= 0 )
+                        return rw;
                 }
 
-                // check & increment instance counter
-                master = sharing_policy::get_master( *this, id, true );
+                return open( path.c_str(), O_RDONLY | O_NONBLOCK );
             }
-#if 0
-            catch(...)
+
+            public:
+
+            device( const std::string &path, bool writable = false ) :
+                fd( open_node( path, writable ) ), gone( fd < 0 ), threaded( false ), monotonic( false ), filled( 0 )
             {
-                throw "";
-            }
+#ifdef EVIOCSCLOCKID
+                // fails on fifos and files
+                int clock_id = CLOCK_MONOTONIC;
+                monotonic = fd >= 0 && ioctl( fd, EVIOCSCLOCKID, &clock_id ) >= 0;
 #endif
+            }
 
-            ~keyboard()
+            ~device()
             {
-                if( master == this )
-                {
-                    // remove pending keystrokes
-
-                    std::cin.clear();
-                    //std::cin.ignore(std::numeric_limits<std::streamsize>::max());
-                }
-
-                // check & decrement instance counter
-                master = sharing_policy::get_master( *this, id, false );
+                if( fd >= 0 )
+                    close( fd );
             }
 
-            static const size_t max_devices = 1;
+            bool is_open() const
+            {
+                return !gone;
+            }
 
-            void clear()
+            void set_threaded( bool on )
             {
-                for( auto &it : keymap )
-                    it.clear();
+                threaded = on;
+            }
 
-                for( auto &it : serial )
-                    it.clear();
+            // events lost because update() did not drain the queue in time
+            size_t drops() const
+            {
+                return queue.drops();
+            }
 
-                debug_key.clear();
-                is_ready.clear();
+            input_stats stats() const
+            {
+                input_stats out = counters;
+                out.dropped = drops();
+                return out;
             }
 
-            void update()
+            // producer: queue every pending event, stamped with 'clock' at read() time
+            void poll( hid::dt &clock )
             {
-                if( master != this )
-                {
-                    this->keymap = master->keymap;
-                    this->serial = master->serial;
-                    this->debug_key = master->debug_key;
-                    this->is_ready = master->is_ready;
+                read_events( clock, false, 0 );
+            }
 
-                    return;
-                    /*
-            hyde::button &a, &b, &c, &d, &e, &f, &g, &h, &i, &j, &k, &l,
-                &m, &n, &o, &p, &q, &r, &s, &t, &u, &v, &w, &x, &y, &z,
-                &one, &two, &three, &four, &five, &six, &seven, &eight, &nine, &zero,
-                &escape, &backspace, &tab, &enter, &shift, &ctrl, &space,
-                &up, &down, &left, &right, &home, &end, &insert, &del,
-                &f1, &f2, &f3, &f4, &f5, &f6, &f7, &f8, &f9, &f10, &f11, &f12,
-                &numpad1, &numpad2, &numpad3, &numpad4, &numpad5,
-                &numpad6, &numpad7, &numpad8, &numpad9, &numpad0,
-                &add, &subtract, &multiply, &divide, &separator, &decimal;
-                */
-                }
+            // consumer: call fn( event ) for every queued event stamped up to 'until'. when not
+            // threaded, pending events are read first and stamped 'until'. returns false if
+            // device is gone. end of file is not an error, so recorded files just run dry.
+            template< typename FN >
+            bool consume( const hid::tick &until, FN fn )
+            {
+                if( !threaded )
+                    read_events( global_timer, true, until );
 
-				if( !GetFocus() )
+                for( const raw_event *event; ( event = queue.front() ) != 0 && event->t <= until; queue.pop() )
                 {
-                    if( GetForegroundWindow() != GetConsoleWindow() )
-                    {
-                        clear();
-                        return;
-                    }
+                    counters.add( until, *event );
+                    fn( *event );
                 }
-                else
+
+                return !gone;
+            }
+
+            protected:
+
+            void read_events( hid::dt &clock, bool stamped, hid::tick stamp )
+            {
+                while( !gone )
                 {
-                    MSG m;
-                    while( PeekMessage( &m, NULL, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE ) )
-                        ;
-                }
+                    ssize_t bytes = read( fd, buffer + filled, sizeof( buffer ) - filled );
+
+                    if( bytes < 0 && errno == EINTR )
+                        continue;
+
+                    if( bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK )
+                        gone = true;    // ENODEV: unplugged. fd is closed on destruction only
 
-                bool is_connected = true;
+                    if( bytes <= 0 )
+                        return;
 
-                // to check: http://molecularmusings.wordpress.com/2011/09/05/properly-handling-keyboard-input/
+                    if( !stamped )
+                        stamp = clock.ticks();
 
-                /*
-                return ( GetFocus() != 0 );
+                    hid::tick offset = 0;
 
-                static HWND myWnd;
-                static struct install { install() {
-                    HWND prevWnd;
-                    myWnd = SetCapture( prevWnd = GetCapture() );
-                    //GetWindowThreadProcessId( myWnd, &myProc );
-                    ReleaseCapture();
-                } } _;
-                return GetForegroundWindow() == myWnd;
-                */
+                    filled += size_t( bytes );
 
-                is_ready.set( is_connected );
+                    size_t records = filled / sizeof( input_event );
 
-                if( !is_connected )
-                    return;
+                    for( size_t i = 0; i < records; ++i )
+                    {
+                        input_event event;
+                        std::copy( buffer + i * sizeof( input_event ), buffer + ( i + 1 ) * sizeof( input_event ), reinterpret_cast< char * >( &event ) );
 
-                //GetKeyboardState( (PBYTE)&keymap ) )
+                        // fifos may carry no timestamps, and recorded files stale ones: ignore
+                        // those older than a second. never newer than the stamp, either
+                        hid::tick source = timestamp( event );
 
-                for( int i = 0; i < 256; ++i )
-                {
-                    SHORT key = GetAsyncKeyState( i );
-                    keymap[ i ].set( key & 0x8000 ? 0.5f : 0.f );
+                        if( source && !offset )
+                            offset = monotonic ? clock.monotonic_offset() : clock.system_offset();
 
-                    //if( key ) serializer << ch; // y q pasa con el cero?
+                        source = source && stamp - ( source - offset ) < hid::dt::to_ticks( 1.0 ) ? (std::min)( source - offset, stamp ) : 0;
+
+                        raw_event raw = { stamp, event.type, event.code, event.value, source };
+                        queue.push( raw );
+                    }
+
+                    filled -= records * sizeof( input_event );
+                    std::copy( buffer + records * sizeof( input_event ), buffer + records * sizeof( input_event ) + filled, buffer );
                 }
             }
-        };
-
 
-        class mouse //, public hyde::enums::mouse
-        {
-            size_t id;
+            // kernel timestamp in nanoseconds since the epoch, or 0 if none
+            static hid::tick timestamp( const input_event &event )
+            {
+#ifdef input_event_sec
+                return hid::tick( event.input_event_sec ) * 1000000000 + hid::tick( event.input_event_usec ) * 1000;
+#else
+                return hid::tick( event.time.tv_sec ) * 1000000000 + hid::tick( event.time.tv_usec ) * 1000;
+#endif
+            }
 
             public:
 
-            enum button_enumeration
+            // full key state, for resyncing after SYN_DROPPED. fails on fifos and files.
+            bool get_keys( unsigned char ( &bits )[ ( KEY_MAX + 7 ) / 8 ] ) const
             {
-                LEFT,
-                MIDDLE,
-                RIGHT
-            };
+                return fd >= 0 && ioctl( fd, EVIOCGKEY( sizeof( bits ) ), bits ) >= 0;
+            }
 
-            enum flag_enumeration
+            // axis range. fails on fifos and files.
+            bool get_range( int axis, int &minimum, int &maximum ) const
             {
-                HOVER,
-                CONNECTED,
-                HIDDEN,
-                CLIPPED,
-                CENTERED
-            };
+                input_absinfo info;
 
-            enum axis_enumeration
+                if( fd < 0 || ioctl( fd, EVIOCGABS( axis ), &info ) < 0 || info.maximum <= info.minimum )
+                    return false;
+
+                minimum = info.minimum;
+                maximum = info.maximum;
+                return true;
+            }
+
+            // plays a rumble effect, strong (low frequency) and weak (high frequency) motors in
+            // [0,65535], until replaced. uploaded on first call, then updated in place: 'effect'
+            // holds the kernel id, -1 if none yet. fails on fifos, files, read-only nodes and
+            // devices without FF_RUMBLE. effects go away with the fd, so there is nothing to stop
+            bool rumble( short &effect, unsigned short strong, unsigned short weak )
             {
-                WHEEL,
-                LOCAL,		// app (dt,dt) center = (0,0)
-                GLOBAL,		// desktop (x,y)
-                CLIENT,		// app (x,y)
-                DESKTOP		// desktop (dt,dt) center = (0,0)
-            };
+                if( fd < 0 || gone )
+                    return false;
 
-            // como hago la memoization?
-            // q es mejor:
-            // - leo las entradas, y cada vez que me preguntan un combo compruebo todas las combinaciones?
-            //   combo["punch"]? : return (if A[0].hold() && A[1].hold() && A[2].hold() && B[3].tap() ? true : false)
-            // - o con cada entrada que leo sigo todas las maquinas de estados vivas, y actualizo valores de retorno
-            //   para cuando me consulten?
-            //   read pad -> A -> fsm #1 -> step3/13 -> combo["punch"] = false;
-            //                    fsm #2 -> step19/19 -> "kick" -> combo["kick"] = true;
-            // - hago un map<string,val> cache; y lo limpio/lleno en cada update?
+                ff_effect ff = {};
+                ff.type = FF_RUMBLE;
+                ff.id = effect;
+                ff.u.rumble.strong_magnitude = strong;
+                ff.u.rumble.weak_magnitude = weak;
 
-            hyde::flags flags;
-            hyde::buttons buttons;
-            hyde::coordinates coordinates;
+                if( ioctl( fd, EVIOCSFF, &ff ) < 0 )
+                    return false;
 
-            hyde::button &left, &middle, &right;
-            hyde::coordinate &wheel, &local, &global, &client, &desktop;
-            hyde::flag &hover, &connected, &hidden, &clipped, &centered;
+                // updating a playing effect is enough
+                if( effect == ff.id )
+                    return true;
 
-            mouse *master;
+                effect = ff.id;
 
-        protected:
-            int ix, iy;
-            bool check_console_window;
+                input_event play = {};
+                play.type = EV_FF;
+                play.code = std::uint16_t( effect );
+                play.value = 1;
 
-        public:
-                 mouse( const size_t &_id, bool check_console_window = false ) :
-                    id(_id), ix(0), iy(0),
-              flags( 5 ), buttons( 3 ), coordinates( 5 ),
-                    left( buttons[ LEFT ] ),
-                  middle( buttons[ MIDDLE ] ),
-                   right( buttons[ RIGHT ] ),
-                   wheel( coordinates[ WHEEL ] ),
-                   local( coordinates[ LOCAL ] ),
-                  global( coordinates[ GLOBAL ] ),
-                  client( coordinates[ CLIENT ]),
-                 desktop( coordinates[ DESKTOP ] ),
-                   hover( flags[ HOVER ] ),
-               connected( flags[ CONNECTED ] ),
-                  hidden( flags[ HIDDEN ] ),
-                 clipped( flags[ CLIPPED ] ),
-                centered( flags[ CENTERED ]),
-               typeof( "hyde::windows::mouse" ),
-          check_console_window( check_console_window )
+                return write( fd, &play, sizeof( play ) ) == ssize_t( sizeof( play ) );
+            }
+
+            // path of the id-th /dev/input/event* node reporting the given EV_KEY code, or "" if none
+            static std::string find( unsigned id, int key_code )
             {
-                if( id >= max_devices )
+                for( int i = 0; i < 64; ++i )
                 {
-                    std::cerr << "error: device id #" << id << " invalid! (seen at " << typeof << " controller)" << std::endl;
-                    assert( false );
-                    return;
+                    char path[32];
+                    std::snprintf( path, sizeof( path ), "/dev/input/event%d", i );
+
+                    int probe = open( path, O_RDONLY | O_NONBLOCK );
+
+                    if( probe < 0 )
+                        continue;
+
+                    unsigned char bits[ ( KEY_MAX + 7 ) / 8 ] = {};
+                    bool found = ioctl( probe, EVIOCGBIT( EV_KEY, sizeof( bits ) ), bits ) >= 0 &&
+                        ( bits[ key_code / 8 ] & ( 1 << ( key_code % 8 ) ) );
+
+                    close( probe );
+
+                    if( found && id-- == 0 )
+                        return path;
                 }
-                //
-                // caps = hyde::caps( max_devices, max_instances_per_device );
 
-                // check & decrement instance counter
-                master = sharing_policy::get_master( *this, id, true );
+                return std::string();
             }
+        };
 
-            ~mouse()
-            {
-                // check & decrement instance counter
-                master = sharing_policy::get_master( *this, id, false );
-            }
+        class keyboard
+        {
+            device dev;
+            bool dropped;
 
-            static const size_t max_devices = 1;
+            public:
 
             const char *const typeof;
 
-            void clear()
-            {
-                for( auto &it : buttons )
-                    it.clear();
-                for( auto &it : coordinates )
-                    it.clear();
-                for( auto &it : flags )
-                    it.clear();
-            }
+            // indexed by evdev KEY_* codes (see linux/input-event-codes.h)
+            hyde::buttons keymap;
 
-            void update()
+            hyde::button &a, &b, &c, &d, &e, &f, &g, &h, &i, &j, &k, &l,
+                &m, &n, &o, &p, &q, &r, &s, &t, &u, &v, &w, &x, &y, &z,
+                &one, &two, &three, &four, &five, &six, &seven, &eight, &nine, &zero,
+                &escape, &backspace, &tab, &enter, &shift, &ctrl, &alt, &space,
+                &up, &down, &left, &right, &home, &end, &insert, &del,
+                &f1, &f2, &f3, &f4, &f5, &f6, &f7, &f8, &f9, &f10, &f11, &f12,
+                &numpad1, &numpad2, &numpad3, &numpad4, &numpad5,
+                &numpad6, &numpad7, &numpad8, &numpad9, &numpad0,
+                &add, &subtract, &multiply, &divide, &separator, &decimal;
+
+            hyde::flag is_ready;
+
+            // state of the 256 first KEY_* codes at last poll, for bulk queries.
+            // keymap histories age lazily from keystate.polls() (see history::age_from())
+            hyde::keyplane keystate;
+
+            // id-th keyboard found in /dev/input
+            keyboard( const unsigned &id = 0 ) : keyboard( device::find( id, KEY_A ) )
+            {}
+
+            // evdev node, fifo or recorded file
+            keyboard( const std::string &path ) :
+                dev( path ), dropped( false ),
+                typeof( "hyde::linux_evdev::keyboard" ),
+                keymap( hyde::keybits::capacity ),
+                a( keymap[ KEY_A ] ), b( keymap[ KEY_B ] ), c( keymap[ KEY_C ] ), d( keymap[ KEY_D ] ),
+                e( keymap[ KEY_E ] ), f( keymap[ KEY_F ] ), g( keymap[ KEY_G ] ), h( keymap[ KEY_H ] ),
+                i( keymap[ KEY_I ] ), j( keymap[ KEY_J ] ), k( keymap[ KEY_K ] ), l( keymap[ KEY_L ] ),
+                m( keymap[ KEY_M ] ), n( keymap[ KEY_N ] ), o( keymap[ KEY_O ] ), p( keymap[ KEY_P ] ),
+                q( keymap[ KEY_Q ] ), r( keymap[ KEY_R ] ), s( keymap[ KEY_S ] ), t( keymap[ KEY_T ] ),
+                u( keymap[ KEY_U ] ), v( keymap[ KEY_V ] ), w( keymap[ KEY_W ] ), x( keymap[ KEY_X ] ),
+                y( keymap[ KEY_Y ] ), z( keymap[ KEY_Z ] ),
+                one( keymap[ KEY_1 ] ), two( keymap[ KEY_2 ] ), three( keymap[ KEY_3 ] ), four( keymap[ KEY_4 ] ),
+                five( keymap[ KEY_5 ] ), six( keymap[ KEY_6 ] ), seven( keymap[ KEY_7 ] ), eight( keymap[ KEY_8 ] ),
+                nine( keymap[ KEY_9 ] ), zero( keymap[ KEY_0 ] ),
+                escape( keymap[ KEY_ESC ] ), backspace( keymap[ KEY_BACKSPACE ] ), tab( keymap[ KEY_TAB ] ),
+                enter( keymap[ KEY_ENTER ] ), shift( keymap[ KEY_LEFTSHIFT ] ), ctrl( keymap[ KEY_LEFTCTRL ] ),
+                alt( keymap[ KEY_LEFTALT ] ), space( keymap[ KEY_SPACE ] ),
+                up( keymap[ KEY_UP ] ), down( keymap[ KEY_DOWN ] ), left( keymap[ KEY_LEFT ] ), right( keymap[ KEY_RIGHT ] ),
+                home( keymap[ KEY_HOME ] ), end( keymap[ KEY_END ] ), insert( keymap[ KEY_INSERT ] ), del( keymap[ KEY_DELETE ] ),
+                f1( keymap[ KEY_F1 ] ), f2( keymap[ KEY_F2 ] ), f3( keymap[ KEY_F3 ] ), f4( keymap[ KEY_F4 ] ),
+                f5( keymap[ KEY_F5 ] ), f6( keymap[ KEY_F6 ] ), f7( keymap[ KEY_F7 ] ), f8( keymap[ KEY_F8 ] ),
+                f9( keymap[ KEY_F9 ] ), f10( keymap[ KEY_F10 ] ), f11( keymap[ KEY_F11 ] ), f12( keymap[ KEY_F12 ] ),
+                numpad1( keymap[ KEY_KP1 ] ), numpad2( keymap[ KEY_KP2 ] ), numpad3( keymap[ KEY_KP3 ] ),
+                numpad4( keymap[ KEY_KP4 ] ), numpad5( keymap[ KEY_KP5 ] ), numpad6( keymap[ KEY_KP6 ] ),
+                numpad7( keymap[ KEY_KP7 ] ), numpad8( keymap[ KEY_KP8 ] ), numpad9( keymap[ KEY_KP9 ] ),
+                numpad0( keymap[ KEY_KP0 ] ),
+                add( keymap[ KEY_KPPLUS ] ), subtract( keymap[ KEY_KPMINUS ] ), multiply( keymap[ KEY_KPASTERISK ] ),
+                divide( keymap[ KEY_KPSLASH ] ), separator( keymap[ KEY_KPCOMMA ] ), decimal( keymap[ KEY_KPDOT ] )
             {
-                if( master != this )
-                {
-                    this->flags = master->flags;
-                    this->buttons = master->buttons;
-                    this->coordinates = master->coordinates;
-                    return;
-                }
+                // same timestamp for keystate and every key, so bulk and per-key queries agree.
+                // a local tick, not a frame: devices may be built on any thread
+                hid::tick now = global_timer.now();
 
-#if 1
+                keystate.reset( now );
 
-                if( !GetFocus() )
-                {
-                    if( GetForegroundWindow() != GetConsoleWindow() )
-                    {
-                        clear();
-                        return;
-                    }
-                }
-                else
+                for( auto &it : keymap )
                 {
-                    MSG m;
-                    while( PeekMessage( &m, NULL, WM_MOUSEFIRST, WM_MOUSELAST, PM_REMOVE ) )
-                        ;
+                    it.clear( now );
+                    it.age_from( &keystate.polls() );
                 }
 
-                // @todo: replace is_present with a proper/reliable is_present() function
+                is_ready.set( dev.is_open() );
+            }
 
-                static HWND parentWnd = 0;
-                static bool is_mouse_present = true;
-                static HCURSOR default_cursor;
-                static HCURSOR hidden_cursor;
-                static HICON hicon;
+            void clear()
+            {
+                hid::tick now = global_timer.now();
 
-                static struct detection_setup {
-                    detection_setup() {
-                        HWND prevWnd; parentWnd = SetCapture( prevWnd = GetCapture() ); //ReleaseCapture();
-                        is_mouse_present = ShowCursor( true ) >= 0;
-                        default_cursor = LoadCursor(0, IDC_ARROW);
+                keystate.reset( now );
 
-                         // make hidden_cursor transparent
+                for( auto &it : keymap )
+                    it.clear( now );
 
-                        int w = GetSystemMetrics( SM_CXCURSOR );
-                        int h = GetSystemMetrics( SM_CYCURSOR );
+                is_ready.clear();
+            }
 
-                        std::vector<unsigned char> and_mask( w * h, 0xFF );
-                        std::vector<unsigned char> xor_mask( w * h, 0x00 );
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                hid::tick now = global_timer.now();
+
+                // keys are set event by event, stamped when read, so a press and release within
+                // the same poll still leave a low -> high -> low trail. value 2 (autorepeat) counts
+                // as pressed.
+                bool alive = dev.consume( now, [&]( const raw_event &event ) {
+                    if( event.type == EV_SYN && event.code == SYN_DROPPED )
+                        dropped = true;
+                    else if( event.type == EV_SYN && event.code == SYN_REPORT && dropped )
+                        resync( event.when() );
+                    else if( event.type == EV_KEY && event.code < hyde::keybits::capacity && !dropped )
+                        press( event.code, event.value != 0, event.when() );
+                } );
+
+                // no flips: just age everything
+                keystate.update( keystate.state(), now );
+
+                is_ready.set( alive );
+            }
 
-                        hidden_cursor = CreateCursor(
-                          0,
-                          1,
-                          1,
-                          w,
-                          h,
-                          &and_mask[0],
-                          &xor_mask[0]
-                        );
+            // see hyde::input_thread
+            void poll( hid::dt &clock )
+            {
+                dev.poll( clock );
+            }
 
-                        BYTE ANDmaskIcon[] = {0xFF, 0xFF, 0xFF, 0xFF,  // line 1
-                                              0xFF, 0xFF, 0xC3, 0xFF,  // line 2
-                                              0xFF, 0xFF, 0x00, 0xFF,  // line 3
-                                              0xFF, 0xFE, 0x00, 0x7F,  // line 4
+            void set_threaded( bool on )
+            {
+                dev.set_threaded( on );
+            }
 
-                                              0xFF, 0xFC, 0x00, 0x1F,  // line 5
-                                              0xFF, 0xF8, 0x00, 0x0F,  // line 6
-                                              0xFF, 0xF8, 0x00, 0x0F,  // line 7
-                                              0xFF, 0xF0, 0x00, 0x07,  // line 8
+            size_t drops() const
+            {
+                return dev.drops();
+            }
 
-                                              0xFF, 0xF0, 0x00, 0x03,  // line 9
-                                              0xFF, 0xE0, 0x00, 0x03,  // line 10
-                                              0xFF, 0xE0, 0x00, 0x01,  // line 11
-                                              0xFF, 0xE0, 0x00, 0x01,  // line 12
+            // latency and event counters, see hyde::input_stats
+            input_stats stats() const
+            {
+                return dev.stats();
+            }
 
-                                              0xFF, 0xF0, 0x00, 0x01,  // line 13
-                                              0xFF, 0xF0, 0x00, 0x00,  // line 14
-                                              0xFF, 0xF8, 0x00, 0x00,  // line 15
-                                              0xFF, 0xFC, 0x00, 0x00,  // line 16
+            protected:
 
-                                              0xFF, 0xFF, 0x00, 0x00,  // line 17
-                                              0xFF, 0xFF, 0x80, 0x00,  // line 18
-                                              0xFF, 0xFF, 0xE0, 0x00,  // line 19
-                                              0xFF, 0xFF, 0xE0, 0x01,  // line 20
+            void press( size_t code, bool on, const hid::tick &when )
+            {
+                hyde::keybits next = keystate.state();
+                next.set( code, on );
 
-                                              0xFF, 0xFF, 0xF0, 0x01,  // line 21
-                                              0xFF, 0xFF, 0xF0, 0x01,  // line 22
-                                              0xFF, 0xFF, 0xF0, 0x03,  // line 23
-                                              0xFF, 0xFF, 0xE0, 0x03,  // line 24
+                // read during this poll, even if the kernel stamped it before the last one
+                hid::tick t = keystate.polls().within( when );
 
-                                              0xFF, 0xFF, 0xE0, 0x07,  // line 25
-                                              0xFF, 0xFF, 0xC0, 0x0F,  // line 26
-                                              0xFF, 0xFF, 0xC0, 0x0F,  // line 27
-                                              0xFF, 0xFF, 0x80, 0x1F,  // line 28
+                keystate.set( next, t ).for_each( [&]( size_t key ) {
+                    keymap[ key ].set_at( t, on ? 0.5f : 0.f );
+                } );
+            }
 
-                                              0xFF, 0xFF, 0x00, 0x7F,  // line 29
-                                              0xFF, 0xFC, 0x00, 0xFF,  // line 30
-                                              0xFF, 0xF8, 0x03, 0xFF,  // line 31
-                                              0xFF, 0xFC, 0x3F, 0xFF}; // line 32
+            void resync( const hid::tick &t )
+            {
+                // kernel buffer overflowed: events up to here are lost, so ask for the full state
+                dropped = false;
 
-                        // Yang-shaped icon XOR mask
+                unsigned char bits[ ( KEY_MAX + 7 ) / 8 ] = {};
 
-                        BYTE XORmaskIcon[] = {0x00, 0x00, 0x00, 0x00,  // line 1
-                                              0x00, 0x00, 0x00, 0x00,  // line 2
-                                              0x00, 0x00, 0x00, 0x00,  // line 3
-                                              0x00, 0x00, 0x00, 0x00,  // line 4
+                if( !dev.get_keys( bits ) )
+                    return;
 
-                                              0x00, 0x00, 0x00, 0x00,  // line 5
-                                              0x00, 0x00, 0x00, 0x00,  // line 6
-                                              0x00, 0x00, 0x00, 0x00,  // line 7
-                                              0x00, 0x00, 0x38, 0x00,  // line 8
+                for( size_t key = 0; key < hyde::keybits::capacity; ++key )
+                    press( key, ( bits[ key / 8 ] >> ( key % 8 ) ) & 1, t );
+            }
+        };
 
-                                              0x00, 0x00, 0x7C, 0x00,  // line 9
-                                              0x00, 0x00, 0x7C, 0x00,  // line 10
-                                              0x00, 0x00, 0x7C, 0x00,  // line 11
-                                              0x00, 0x00, 0x38, 0x00,  // line 12
+        class gamepad
+        {
+            device dev;
 
-                                              0x00, 0x00, 0x00, 0x00,  // line 13
-                                              0x00, 0x00, 0x00, 0x00,  // line 14
-                                              0x00, 0x00, 0x00, 0x00,  // line 15
-                                              0x00, 0x00, 0x00, 0x00,  // line 16
+            // raw axis values, and their ranges (xpad defaults, when ioctl is not available)
+            enum { LX, LY, RX, RY, LT, RT, HX, HY, AXES };
+            int axis[ AXES ], minimum[ AXES ], maximum[ AXES ];
 
-                                              0x00, 0x00, 0x00, 0x00,  // line 17
-                                              0x00, 0x00, 0x00, 0x00,  // line 18
-                                              0x00, 0x00, 0x00, 0x00,  // line 19
-                                              0x00, 0x00, 0x00, 0x00,  // line 20
+            // buttons are only set on events, and age lazily from here (see history::age_from())
+            hid::polls polled;
+
+            // kernel id of the rumble effect (-1 until uploaded), and the motor speeds it plays
+            short effect;
+            unsigned short playing[2];
 
-                                              0x00, 0x00, 0x00, 0x00,  // line 21
-                                              0x00, 0x00, 0x00, 0x00,  // line 22
-                                              0x00, 0x00, 0x00, 0x00,  // line 23
-                                              0x00, 0x00, 0x00, 0x00,  // line 24
+            public:
 
-                                              0x00, 0x00, 0x00, 0x00,  // line 25
-                                              0x00, 0x00, 0x00, 0x00,  // line 26
-                                              0x00, 0x00, 0x00, 0x00,  // line 27
-                                              0x00, 0x00, 0x00, 0x00,  // line 28
+            const char *const typeof;
 
-                                              0x00, 0x00, 0x00, 0x00,  // line 29
-                                              0x00, 0x00, 0x00, 0x00,  // line 30
-                                              0x00, 0x00, 0x00, 0x00,  // line 31
-                                              0x00, 0x00, 0x00, 0x00}; // line 32
+            // 10x buttons,   1d data input (action)
+            //  2x triggers,  1d data input (action)
+            hyde::button
+                a, b, x, y,
+                back, start,
+                lb, rb,
+                lthumb, rthumb,
+                ltrigger, rtrigger;
+
+            //  2x axis,      2d data input (spatial)
+            //  1x gamepad,   2d data input (spatial)
+            hyde::coordinate
+                pad,
+                lpad, rpad;
+
+            // 2x rumble,     1d data output (rumble haptic)
+            // left (strong) and right (weak) motors, in [0,1]. sent on update() as an FF_RUMBLE
+            // effect, if the node could be opened for writing
+            hyde::buttons rumble;
+
+            hyde::flag
+                is_ready;
+
+            // id-th gamepad found in /dev/input
+            gamepad( const unsigned &id = 0 ) : gamepad( device::find( id, BTN_GAMEPAD ) )
+            {}
+
+            // evdev node, fifo or recorded file
+            gamepad( const std::string &path ) :
+                dev( path, true ),
+                effect( -1 ),
+                typeof( "hyde::linux_evdev::gamepad" ),
+                rumble( 2 )
+            {
+                playing[0] = playing[1] = 0;
 
-                        HINSTANCE hInstance = (HINSTANCE)GetModuleHandle(NULL);
+                static const int codes[ AXES ] = { ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ, ABS_HAT0X, ABS_HAT0Y };
+                static const int defaults[ AXES ][2] = { {-32768,32767}, {-32768,32767}, {-32768,32767}, {-32768,32767}, {0,255}, {0,255}, {-1,1}, {-1,1} };
 
-                        hicon  = CreateIcon(hInstance, // handle to app. instance
-                                     32,               // icon width
-                                     32,               // icon height
-                                     1,                // number of XOR planes
-                                     1,                // number of bits per pixel
-                                     ANDmaskIcon,      // AND mask
-                                     XORmaskIcon);     // XOR mask
+                for( int i = 0; i < AXES; ++i )
+                {
+                    if( !dev.get_range( codes[i], minimum[i], maximum[i] ) )
+                    {
+                        minimum[i] = defaults[i][0];
+                        maximum[i] = defaults[i][1];
                     }
-                    ~detection_setup() {
-                        ReleaseCapture();
-                        SetCursor(default_cursor);
-                        DestroyCursor(hidden_cursor);
-                    }}_;
 
-                connected.set( is_mouse_present ? 0.5f : 0.f );
+                    // sticks and hats rest at center, triggers at minimum
+                    axis[i] = ( i == LT || i == RT ) ? minimum[i] : ( minimum[i] + maximum[i] + 1 ) / 2;
+                }
 
-                if( !is_mouse_present )
-                    return;
+                hyde::button *buttons[] = { &a, &b, &x, &y, &back, &start, &lb, &rb, &lthumb, &rthumb };
 
-                // process outputs 1/3
+                polled = hid::polls( global_timer.now() );
 
-                //SetClassLong( hWnd, GCL_HCURSOR, (LONG)( default_cursor ) );
+                for( auto *it : buttons )
+                    it->age_from( &polled );
 
-                // process inputs
+                is_ready.set( dev.is_open() );
+            }
 
-                SHORT lkey = GetAsyncKeyState( VK_LBUTTON );
-                SHORT mkey = GetAsyncKeyState( VK_MBUTTON );
-                SHORT rkey = GetAsyncKeyState( VK_RBUTTON );
+            void clear()
+            {
+                a.clear();
+                b.clear();
+                x.clear();
+                y.clear();
+                back.clear();
+                start.clear();
+                lb.clear();
+                rb.clear();
+                lthumb.clear();
+                rthumb.clear();
+                ltrigger.clear();
+                rtrigger.clear();
+                pad.clear();
+                lpad.clear();
+                rpad.clear();
+                is_ready.clear();
 
-                  left.set( lkey & 0x8000 ? 0.5f : 0.f );
-                middle.set( mkey & 0x8000 ? 0.5f : 0.f );
-                 right.set( rkey & 0x8000 ? 0.5f : 0.f );
+                for( auto &it : rumble )
+                    it.clear();
 
-                bool is_hover = false;
+                polled = hid::polls( global_timer.now() );
+            }
 
-                CURSORINFO ci;
-                ci.cbSize = sizeof(CURSORINFO);
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
 
-                // disable clipping
-                ClipCursor( 0 );
+                // process inputs : buttons, event by event so short taps are kept.
+                // axes are stored and set once per poll, stamped at their last event
 
-                if( GetCursorInfo( &ci ) )
-                {
-                    POINT pPoint = ci.ptScreenPos;
+                hid::tick moved = 0;
 
-                    // set virtual screen coordinates in normalised [-1,+1]x[-1,+1] form whose center is (0,0)
+                bool alive = dev.consume( global_timer.now(), [&]( const raw_event &event ) {
+                    if( event.type == EV_KEY )
                     {
-                        float gx, gy;
+                        float on = event.value ? 1.0f : 0.f;
+                        hid::tick t = polled.within( event.when() );
 
-                        gx = -1.0f + float(pPoint.x+pPoint.x) / float( GetSystemMetrics( SM_CXVIRTUALSCREEN ) );
-                        gy =  1.0f - float(pPoint.y+pPoint.y) / float( GetSystemMetrics( SM_CYVIRTUALSCREEN ) );
+                        switch( event.code )
+                        {
+                            case BTN_A:      a.set_at( t, on ); break;
+                            case BTN_B:      b.set_at( t, on ); break;
+                            case BTN_X:      x.set_at( t, on ); break;
+                            case BTN_Y:      y.set_at( t, on ); break;
+                            case BTN_SELECT: back.set_at( t, on ); break;
+                            case BTN_START:  start.set_at( t, on ); break;
+                            case BTN_TL:     lb.set_at( t, on ); break;
+                            case BTN_TR:     rb.set_at( t, on ); break;
+                            case BTN_THUMBL: lthumb.set_at( t, on ); break;
+                            case BTN_THUMBR: rthumb.set_at( t, on ); break;
+                            default: break;
+                        }
+                    }
+                    else if( event.type == EV_ABS )
+                    {
+                        moved = event.when();
 
-                        desktop.set( pPoint.x, pPoint.y );
-                        global.set( gx, gy );
+                        switch( event.code )
+                        {
+                            case ABS_X:     axis[ LX ] = event.value; break;
+                            case ABS_Y:     axis[ LY ] = event.value; break;
+                            case ABS_RX:    axis[ RX ] = event.value; break;
+                            case ABS_RY:    axis[ RY ] = event.value; break;
+                            case ABS_Z:     axis[ LT ] = event.value; break;
+                            case ABS_RZ:    axis[ RT ] = event.value; break;
+                            case ABS_HAT0X: axis[ HX ] = event.value; break;
+                            case ABS_HAT0Y: axis[ HY ] = event.value; break;
+                            default: break;
+                        }
                     }
+                } );
 
-                    HWND hWnd = WindowFromPoint( pPoint );
+                polled.advance( global_timer.now() );
 
-                    // if [ parent window, console window, or kind-of-subchild ] then...
-                    if( hWnd == parentWnd || (hWnd == GetConsoleWindow() && check_console_window) || GetWindowLongPtr(hWnd, GWLP_WNDPROC) )
-                    {
-                        // point inside any of our windows
-                        is_hover = true;
+                is_ready.set( alive );
 
-                        // transform point into window->client rect coordinates
-                        WINDOWINFO wi;
-                        wi.cbSize=sizeof(WINDOWINFO);
-                        GetWindowInfo(hWnd, &wi);
+                if( !alive )
+                    return;
 
-                        if( centered.hold() )
-                        {
-                            int cx = ( wi.rcClient.right - wi.rcClient.left ) / 2 + wi.rcClient.left;
-                            int cy = ( wi.rcClient.bottom - wi.rcClient.top ) / 2 + wi.rcClient.top;
+                hid::tick t = moved ? moved : global_timer.now();
 
-                            int dx = pPoint.x - cx;
-                            int dy = pPoint.y - cy;
+                // process inputs : triggers
 
-                            SetCursorPos( cx, cy );
+                ltrigger.set_at( t, unit( LT ) );
+                rtrigger.set_at( t, unit( RT ) );
 
-                            client.set( ix += dx, iy += dy );
-                        }
-                        else
-                        {
-                            pPoint.x -= wi.rcClient.left;
-                            pPoint.y -= wi.rcClient.top;
+                // process inputs : digital pad and thumb pads (evdev y axes grow downwards)
 
-                            client.set( ix = pPoint.x, iy = pPoint.y );
-                        }
+                pad.set_at( t, signed_unit( HX ), -signed_unit( HY ) );
+                lpad.set_at( t, signed_unit( LX ), -signed_unit( LY ) );
+                rpad.set_at( t, signed_unit( RX ), -signed_unit( RY ) );
 
-                        // set coordinate in normalised [-1,+1]x[-1,+1] form whose center is (0,0)
-                        {
-                            float lx, ly;
+                // process outputs : rumble
 
-                            lx = -1.0f + float(pPoint.x+pPoint.x) / float( wi.rcClient.right - wi.rcClient.left );
-                            ly =  1.0f - float(pPoint.y+pPoint.y) / float( wi.rcClient.bottom - wi.rcClient.top + 1 );
+                set_rumble( rumble[0].newest().x, rumble[1].newest().x );
+            }
 
-                            local.set( lx, ly );
-                        }
+            // see hyde::input_thread
+            void poll( hid::dt &clock )
+            {
+                dev.poll( clock );
+            }
 
-                        // process outputs 2/3: enable clipping, if required
-                        if( clipped.hold() ) ClipCursor( &wi.rcClient );
-                    }
+            void set_threaded( bool on )
+            {
+                dev.set_threaded( on );
+            }
 
-                    // process outputs 3/3: hide cursor, if required
+            size_t drops() const
+            {
+                return dev.drops();
+            }
 
-                    {
-                        bool hide_request = hidden.hold();
-                        bool show_request = hidden.idle();
+            // latency and event counters, see hyde::input_stats
+            input_stats stats() const
+            {
+                return dev.stats();
+            }
 
-                        // method #1
-						if(0)
-                        {
-                            ShowCursor( TRUE );
-                            int counter = ShowCursor( FALSE ); //<0: no mouse installed, or hidden cursor
+            protected:
 
-                            bool visible = (counter >= 0);
+            // sent on change only: each call is an ioctl
+            void set_rumble( const float &left01, const float &right01 )
+            {
+                assert( left01 >= 0.f && left01 <= 1.f );
+                assert( right01 >= 0.f && right01 <= 1.f );
 
-                            if( visible )
-                            {
-                                if( hide_request ) while(counter>=0) counter=ShowCursor(FALSE);
-                            }
-                            else
-                            {
-                                if( show_request ) while(counter <0) counter=ShowCursor(TRUE);
-                            }
-                        }
+                unsigned short strong = (unsigned short)( left01 * 65535.f );
+                unsigned short weak = (unsigned short)( right01 * 65535.f );
 
-                        // method #2
-						if(0)
-                        SetClassLongPtr( hWnd, GCLP_HCURSOR, (LONG)( show_request ? default_cursor : hidden_cursor ) );
+                if( strong == playing[0] && weak == playing[1] )
+                    return;
 
-						// method #3
-						if( hide_request ) while( ShowCursor(FALSE) >= 0 ) ;
-						else
-						if( show_request ) while( ShowCursor(TRUE) < 0 ) ;
-                    }
+                playing[0] = strong;
+                playing[1] = weak;
 
-                    // stupid feature:
+                dev.rumble( effect, strong, weak );
+            }
 
-                    SetClassLongPtr( hWnd, GCLP_HICON, (LONG)(hicon) );
-                }
+            // [min,max] -> [0,1]
+            float unit( int i ) const
+            {
+                return float( axis[i] - minimum[i] ) / float( maximum[i] - minimum[i] );
+            }
 
-                hover.set( is_hover ? 0.5f : 0.f );
+            // [min,center,max] -> [-1,0,1]
+            float signed_unit( int i ) const
+            {
+                int center = ( minimum[i] + maximum[i] + 1 ) / 2;
+                int offset = axis[i] - center;
+                return float( offset ) / float( offset > 0 ? maximum[i] - center : center - minimum[i] );
+            }
+        };
 
-#endif
+        class mouse
+        {
+            device dev;
 
+            // accumulated relative motion and wheel
+            int x, y;
+            float wx, wy;
 
+            // buttons are only set on events, and age lazily from here (see history::age_from())
+            hid::polls polled;
 
+            public:
 
-                static struct once {
-                    once() {
-                        const int num_mice = ManyMouse_Init();
-                        driver = ManyMouse_DriverName();
-                        for( int i = 0; i < num_mice; ++i )
-                        {
-                            drivers.push_back( ManyMouse_DeviceName(i) );
-                        }
-                    }
-                    ~once() {
-                        ManyMouse_Quit();
-                    }
-                    const char *driver;
-                    std::vector<const char *> drivers;
-                } lib;
+            const char *const typeof;
 
-                    ManyMouseEvent event;
-                    static float dx = 0, dy = 0;
+            hyde::button
+                left, middle, right;
 
-                    if( ManyMouse_PollEvent(&event) && event.device == 0 )
-                    {
-                        if (event.type == MANYMOUSE_EVENT_SCROLL )
-                        {
-                            if( event.item == 0 )
-                            {
-                                dy += ( event.value > 0 ? 1 : -1 ) * 0.100f;
-                            }
-                            else
-                            {
-                                dx += ( event.value > 0 ? 1 : -1 ) * 0.100f;
-                            }
-                        }
+            // motion: accumulated relative motion, in device counts (y grows downwards). kept for
+            // the last 2 seconds rather than the last N samples, whatever the mouse rate.
+            // wheel: accumulated wheel steps, 0.1 per step as in hyde::windows::mouse
+            hyde::timed_coordinate
+                motion;
+            hyde::coordinate
+                wheel;
 
-#if 0
-                        else if (event.type == MANYMOUSE_EVENT_RELMOTION )
-                        {
-                            printf("Mouse #%u relative motion %s %d\n", event.device,
-                                    event.item == 0 ? "X" : "Y", event.value);
-                        }
+            hyde::flag
+                is_ready;
 
-                        else if (event.type == MANYMOUSE_EVENT_ABSMOTION )
-                        {
-                            printf("Mouse #%u absolute motion %s %d\n", event.device,
-                                    event.item == 0 ? "X" : "Y", event.value);
-                        }
+            // relative motion is summed into one motion sample per poll (see motion_coalescer).
+            // coalescing.set_quantum( seconds ) splits polls into finer samples instead.
+            hyde::motion_coalescer coalescing;
 
-                        else if (event.type == MANYMOUSE_EVENT_BUTTON )
-                        {
-                            if( event.item == 0 ) buttons[ LEFT ].set( event.value ? 0.5f : 0.f );
-                            else
-                            if( event.item == 1 ) buttons[ MIDDLE ].set( event.value ? 0.5f : 0.f );
-                            else
-                            if( event.item == 2 ) buttons[ RIGHT ].set( event.value ? 0.5f : 0.f );
-                        }
+            // id-th mouse found in /dev/input
+            mouse( const unsigned &id = 0 ) : mouse( device::find( id, BTN_LEFT ) )
+            {}
 
-                        else if (event.type == MANYMOUSE_EVENT_DISCONNECT )
-                        {
-                            connected.set( 0.f );
-                        }
+            // evdev node, fifo or recorded file
+            mouse( const std::string &path ) :
+                dev( path ), x( 0 ), y( 0 ), wx( 0 ), wy( 0 ),
+                typeof( "hyde::linux_evdev::mouse" )
+            {
+                polled = hid::polls( global_timer.now() );
 
-                        else
+                left.age_from( &polled );
+                middle.age_from( &polled );
+                right.age_from( &polled );
+
+                is_ready.set( dev.is_open() );
+            }
+
+            void clear()
+            {
+                left.clear();
+                middle.clear();
+                right.clear();
+                motion.clear();
+                wheel.clear();
+                is_ready.clear();
+
+                polled = hid::polls( global_timer.now() );
+            }
+
+            void update()
+            {
+                // single timestamp for the whole poll cycle
+                hid::frame poll( global_timer );
+
+                auto emit = [&]( const hid::tick &t, int dx, int dy ) {
+                    motion.set_at( t, float( x += dx ), float( y += dy ) );
+                };
+
+                // buttons are set event by event, flushing pending motion first, so edges keep
+                // their exact timestamp and position
+                bool alive = dev.consume( global_timer.now(), [&]( const raw_event &event ) {
+                    if( event.type == EV_REL )
+                    {
+                        switch( event.code )
                         {
-                            // unhandled event.type
+                            case REL_X:      coalescing.add( event.when(), 0, event.value, emit ); break;
+                            case REL_Y:      coalescing.add( event.when(), 1, event.value, emit ); break;
+                            case REL_WHEEL:  wheel.set_at( event.when(), wx, wy += event.value * 0.100f ); break;
+                            case REL_HWHEEL: wheel.set_at( event.when(), wx += event.value * 0.100f, wy ); break;
+                            default: break;
                         }
-#endif
+                    }
+                    else if( event.type == EV_KEY && ( event.code == BTN_LEFT || event.code == BTN_MIDDLE || event.code == BTN_RIGHT ) )
+                    {
+                        coalescing.flush( emit );
 
+                        hyde::button &button = event.code == BTN_LEFT ? left : event.code == BTN_MIDDLE ? middle : right;
+                        button.set_at( polled.within( event.when() ), event.value ? 0.5f : 0.f );
                     }
+                } );
 
-                    wheel.set( dx, dy );
+                coalescing.flush( emit );
+
+                polled.advance( global_timer.now() );
+
+                is_ready.set( alive );
+            }
+
+            // see hyde::input_thread
+            void poll( hid::dt &clock )
+            {
+                dev.poll( clock );
+            }
+
+            void set_threaded( bool on )
+            {
+                dev.set_threaded( on );
+            }
+
+            size_t drops() const
+            {
+                return dev.drops();
+            }
+
+            // latency and event counters, see hyde::input_stats
+            input_stats stats() const
+            {
+                input_stats out = dev.stats();
+                out.coalesced = coalescing.events() - coalescing.samples();
+                return out;
             }
         };
     }
 }
 
-
 #endif
@@ -0,0 +1,87 @@
+// linux evdev keyboard & gamepad.
+// usage: sample.evdev [keyboard-path [gamepad-path]]
+// paths can be evdev nodes, fifos or recorded files (ie, cat /dev/input/event3 > keyboard.rec).
+// with no arguments, both devices are fed synthetic events through pipes, so no hardware is needed.
+// see test/test.evdev.cc for the same pipe setup checked against expected gestures and timestamps.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "hyde.hpp"
+
+void put( int fd, const input_event &event )
+{
+    if( write( fd, &event, sizeof( event ) ) != ssize_t( sizeof( event ) ) )
+    {
+        std::cerr << "write() failed" << std::endl;
+        std::exit( EXIT_FAILURE );
+    }
+}
+
+void feed( int fd, const unsigned short type, const unsigned short code, const int value )
+{
+    input_event event = {};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    put( fd, event );
+
+    input_event report = {};
+    report.type = EV_SYN;
+    report.code = SYN_REPORT;
+    put( fd, report );
+}
+
+std::string pipe_path( int fds[2] )
+{
+    if( pipe( fds ) != 0 )
+    {
+        std::cerr << "pipe() failed" << std::endl;
+        std::exit( EXIT_FAILURE );
+    }
+
+    return "/dev/fd/" + std::to_string( fds[0] );
+}
+
+int main( int argc, char **argv )
+{
+    int kfd[2] = { -1, -1 }, gfd[2] = { -1, -1 };
+
+    hyde::linux_evdev::keyboard keyboard( argc > 1 ? std::string( argv[1] ) : pipe_path( kfd ) );
+    hyde::linux_evdev::gamepad pad( argc > 2 ? std::string( argv[2] ) : pipe_path( gfd ) );
+
+    for( int frame = 0; argc > 1 || frame < 60; ++frame )
+    {
+        if( argc == 1 )
+        {
+            // a tap on 't', a held space, a sweep on the left stick and 'a' on the pad
+            if( frame == 10 ) feed( kfd[1], EV_KEY, KEY_T, 1 ), feed( kfd[1], EV_KEY, KEY_T, 0 );
+            if( frame == 20 ) feed( kfd[1], EV_KEY, KEY_SPACE, 1 );
+            if( frame == 40 ) feed( kfd[1], EV_KEY, KEY_SPACE, 0 );
+            if( frame == 30 ) feed( gfd[1], EV_KEY, BTN_A, 1 );
+            if( frame == 50 ) feed( gfd[1], EV_KEY, BTN_A, 0 );
+            feed( gfd[1], EV_ABS, ABS_X, ( frame * 1092 ) - 32768 );
+        }
+
+        keyboard.update();
+        pad.update();
+
+        std::cout
+            << "T[" << ( keyboard.t.click() ? "x]" : " ]" )
+            << "SPC[" << ( keyboard.space.hold() ? "x]" : " ]" )
+            << "ESC[" << ( keyboard.escape.hold() ? "x]" : " ]" )
+            << " pad.a[" << ( pad.a.hold() ? "x]" : " ]" )
+            << " lpad(" << pad.lpad.newest().x << ',' << pad.lpad.newest().y << ')'
+            << " ready(" << keyboard.is_ready.newest().x << ',' << pad.is_ready.newest().x << ")"
+            << "               " << ( argc > 1 ? '\r' : '\n' );
+
+        if( keyboard.escape.trigger() || pad.start.trigger() )
+            break;
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 16 ) );
+    }
+
+    return 0;
+}
@@ -14,7 +14,7 @@ int main( int argc, char **argv )
         hyde::windows::gamepad gamepad4(3);
         // following line is wrong: hyde::windows::gamepad driver supports only 4 instances at once
         hyde::windows::gamepad gamepad5(4);
-        // following line is wrong: device id #0 is already being used
+        // following line is ok too: shares device id #0 state with gamepad1 (see hyde::sharing_policy)
         hyde::windows::gamepad gamepad6(0);
 
         // following line is unreachable
@@ -26,7 +26,7 @@ int main( int argc, char **argv )
         hyde::windows::mouse mouse1(0);
         // following line is wrong: hyde::windows::mouse driver supports only 1 instance at once
         hyde::windows::mouse mouse2(1);
-        // following line is wrong: device id #0 is already in use
+        // following line is ok too: shares device id #0 state with mouse1
         hyde::windows::mouse mouse3(0);
 
         // following line is unreachable
@@ -38,7 +38,7 @@ int main( int argc, char **argv )
         hyde::windows::keyboard keyboard1(0);
         // following line is wrong: hyde::windows::keyboard driver supports only 1 instance at once
         hyde::windows::keyboard keyboard2(1);
-        // following line is wrong: device id #0 is already in use
+        // following line is ok too: shares device id #0 state with keyboard1
         hyde::windows::keyboard keyboard3(0);
 
         // following line is unreachable
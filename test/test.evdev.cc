@@ -0,0 +1,135 @@
+// checks hyde::linux_evdev::keyboard against known input_event records written into a pipe.
+// runs under a hid::virtual_clock, so gesture windows and timestamps are exact.
+// usage: test.evdev (exits 0 on success, asserts otherwise)
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../hyde.hpp"
+
+int fds[2] = { -1, -1 };
+
+// kernel-like timestamp (CLOCK_REALTIME, as evdev stamps by default) of a virtual tick
+timeval realtime( const hyde::hid::tick &t )
+{
+    hyde::hid::tick ns = hyde::global_timer.system_offset() + t;
+
+    timeval tv;
+    tv.tv_sec = time_t( ns / 1000000000 );
+    tv.tv_usec = suseconds_t( ( ns % 1000000000 ) / 1000 );
+    return tv;
+}
+
+void put( const input_event &event )
+{
+    ssize_t bytes = write( fds[1], &event, sizeof( event ) );
+    assert( bytes == ssize_t( sizeof( event ) ) );
+    (void)bytes;
+}
+
+// key event plus its SYN_REPORT. a zero timeval means no kernel timestamp
+void feed( unsigned short code, int value, const timeval &time = timeval() )
+{
+    input_event event = {};
+    event.time = time;
+    event.type = EV_KEY;
+    event.code = code;
+    event.value = value;
+    put( event );
+
+    input_event report = {};
+    report.time = time;
+    report.type = EV_SYN;
+    report.code = SYN_REPORT;
+    put( report );
+}
+
+int main()
+{
+    if( pipe( fds ) != 0 )
+    {
+        std::cerr << "pipe() failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    hyde::hid::virtual_clock clock( 1000000000 );
+    hyde::hid::clock_scope scope( &clock );
+
+    hyde::linux_evdev::keyboard keyboard( "/dev/fd/" + std::to_string( fds[0] ) );
+
+    keyboard.update();
+    assert( keyboard.is_ready.newest().x );
+    assert( !keyboard.space.hold() && !keyboard.space.trigger() );
+
+    clock.advance( 0.1 );
+    keyboard.update();
+    assert( keyboard.space.idle() );
+
+    // press without kernel timestamp: stamped when read, at the poll tick
+    clock.advance( 0.1 );
+    feed( KEY_SPACE, 1 );
+    keyboard.update();
+
+    hyde::hid::tick pressed = clock.now();
+    assert( keyboard.space.newest().t == pressed );
+    assert( keyboard.space.trigger() && keyboard.space.hold() );
+    assert( !keyboard.space.release() && !keyboard.space.idle() );
+
+    // held: still high, no longer a trigger
+    clock.advance( 0.1 );
+    keyboard.update();
+    assert( keyboard.space.hold() && !keyboard.space.trigger() );
+    assert( keyboard.space.newest_t() == clock.now() );
+    assert( keyboard.stats().processed == 2 );
+
+    // autorepeat (value 2) keeps it pressed, without a new sample
+    feed( KEY_SPACE, 2 );
+    clock.advance( 0.1 );
+    keyboard.update();
+    assert( keyboard.space.hold() && !keyboard.space.longpress() );
+    assert( keyboard.space.newest().t == pressed );
+
+    // release stamped by the kernel 5 ms before the poll: sample keeps the kernel time,
+    // and the press is held until then
+    clock.advance( 0.1 );
+    hyde::hid::tick released = clock.now() - 5000000;
+    feed( KEY_SPACE, 0, realtime( released ) );
+    keyboard.update();
+
+    // timeval has microsecond resolution, and offsets are sampled at slightly different times
+    assert( std::abs( keyboard.space.newest().t - released ) < 1000000 );
+    assert( keyboard.space.at(1).t == keyboard.space.newest().t );
+    assert( keyboard.space.at(1).x == 0.5f && keyboard.space.at(2).t == pressed );
+    assert( keyboard.space.release() && !keyboard.space.hold() );
+    assert( keyboard.space.click() && !keyboard.space.click( 0.25f ) );
+
+    // release gets old
+    clock.advance( 0.1 );
+    keyboard.update();
+    assert( !keyboard.space.release() && keyboard.space.idle() );
+
+    // tap within a single poll: press and release both read at the poll tick
+    clock.advance( 0.1 );
+    feed( KEY_T, 1 );
+    feed( KEY_T, 0 );
+    keyboard.update();
+    assert( keyboard.t.click() && keyboard.t.release() && !keyboard.t.hold() );
+    assert( keyboard.t.newest().t == clock.now() );
+
+    // stale kernel timestamps (over a second old, ie replayed recordings) fall back to the read tick
+    clock.advance( 0.1 );
+    feed( KEY_ESC, 1, realtime( clock.now() - 5000000000LL ) );
+    keyboard.update();
+    assert( keyboard.escape.trigger() && keyboard.escape.newest().t == clock.now() );
+
+    assert( keyboard.stats().processed == 12 );
+    assert( keyboard.drops() == 0 );
+
+    close( fds[1] );
+    close( fds[0] );
+
+    std::cout << "test.evdev: ok" << std::endl;
+    return EXIT_SUCCESS;
+}
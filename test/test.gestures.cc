@@ -0,0 +1,171 @@
+// checks that edge predicates (trigger, release, click) hold on exactly one poll, whatever the
+// polling rate, both for controls set every poll and for controls devices only set on events
+// (lazily aged keymaps and buttons). also checks held values are not reported as changes.
+// runs under a hid::virtual_clock, so polls are exactly spaced.
+// usage: test.gestures (exits 0 on success, asserts otherwise)
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../hyde.hpp"
+
+// polls each predicate held on, and the first one it held on
+struct tally
+{
+    size_t idle, trigger, hold, release, click;
+    size_t first_trigger, first_release;
+
+    tally() : idle(0), trigger(0), hold(0), release(0), click(0), first_trigger(0), first_release(0)
+    {}
+
+    void add( const hyde::button &button, size_t poll )
+    {
+        if( button.trigger() && !trigger++ )
+            first_trigger = poll;
+        if( button.release() && !release++ )
+            first_release = poll;
+
+        idle += button.idle();
+        hold += button.hold();
+        click += button.click();
+    }
+};
+
+const hyde::hid::tick ms = 1000000;
+
+// a button set every poll, pressed during polls [from,to). plain histories keep a sample per
+// poll, so click() only sees presses of a single poll; aged ones keep changes only
+void every_poll( double hz, size_t from, size_t to, bool aged )
+{
+    hyde::hid::virtual_clock clock( 1000000000 );
+    hyde::hid::clock_scope scope( &clock );
+
+    hyde::hid::polls polled( clock.now() );
+    hyde::button button;
+    tally seen;
+
+    if( aged )
+        button.age_from( &polled );
+
+    const size_t polls = to + 30;
+
+    for( size_t p = 0; p < polls; ++p )
+    {
+        clock.advance( 1 / hz );
+        button.set( p >= from && p < to ? 0.5f : 0.f );
+        polled.advance( clock.now() );
+        seen.add( button, p );
+    }
+
+    size_t clicks = aged ? ( to - from ) / hz <= 0.5 : to - from == 1;
+
+    assert( seen.trigger == 1 && seen.first_trigger == from );
+    assert( seen.release == 1 && seen.first_release == to );
+    assert( seen.hold == to - from );
+    assert( seen.click == clicks );
+    assert( seen.idle == polls - ( to - from ) - 1 );
+}
+
+// a key or a mouse button, only set on events: a tap of 'tap' ticks after 200 ms, polled at hz
+template< typename DEVICE, typename SELECT >
+void on_events( double hz, hyde::hid::tick tap, unsigned short type, unsigned short code, SELECT select )
+{
+    hyde::hid::virtual_clock clock( 1000000000 );
+    hyde::hid::clock_scope scope( &clock );
+
+    DEVICE device;
+    std::vector< hyde::raw_event > script;
+
+    hyde::raw_event press = { 200 * ms, type, code, 1, 0 };
+    hyde::raw_event release = { 200 * ms + tap, type, code, 0, 0 };
+    script.push_back( press );
+    script.push_back( release );
+
+    device.add_generator( hyde::synthetic::scripted_generator( script ) );
+
+    const hyde::button &button = select( device );
+    tally seen;
+
+    // first update starts the script
+    device.update();
+    hyde::hid::tick origin = clock.now();
+
+    size_t polls = 0;
+
+    for( ; clock.now() < origin + 1000 * ms; ++polls )
+    {
+        clock.advance( 1 / hz );
+        device.update();
+        seen.add( button, polls );
+    }
+
+    assert( seen.release == 1 && seen.click == 1 );
+    assert( seen.trigger == ( seen.hold ? 1 : 0 ) );
+    assert( seen.trigger == 0 || seen.first_trigger < seen.first_release );
+    assert( seen.idle == polls - seen.hold - 1 );
+}
+
+// holding a value does not report it as a change (see hyde::hub::changed())
+void changes()
+{
+    hyde::hid::virtual_clock clock( 1000000000 );
+    hyde::hid::clock_scope scope( &clock );
+
+    hyde::button button;
+    std::vector< const void * > changed;
+
+    float values[] = { 0.f, 0.5f, 0.5f, 0.f, 0.f };
+    size_t expected[] = { 0, 1, 0, 1, 0 };
+
+    for( size_t p = 0; p < 5; ++p )
+    {
+        clock.advance( 1 / 60.0 );
+
+        changed.clear();
+        {
+            hyde::hid::frame poll( hyde::global_timer, &changed );
+            button.set( values[p] );
+        }
+
+        assert( changed.size() == expected[p] );
+    }
+}
+
+const hyde::button &key_a( const hyde::synthetic::keyboard &keyboard )
+{
+    return keyboard.a;
+}
+
+const hyde::button &left_button( const hyde::synthetic::mouse &mouse )
+{
+    return mouse.left;
+}
+
+int main()
+{
+    const double rates[] = { 60, 144, 1000 };
+
+    for( double hz : rates )
+    {
+        // single poll press, short tap, long press
+        for( bool aged : { false, true } )
+        {
+            every_poll( hz, 10, 11, aged );
+            every_poll( hz, 10, 10 + size_t( 0.1 * hz ), aged );
+            every_poll( hz, 10, 10 + size_t( 0.8 * hz ), aged );
+        }
+
+        // 100 ms taps and taps shorter than a poll
+        on_events< hyde::synthetic::keyboard >( hz, 100 * ms, hyde::synthetic::KEY, 'A', key_a );
+        on_events< hyde::synthetic::keyboard >( hz, ms / 2, hyde::synthetic::KEY, 'A', key_a );
+        on_events< hyde::synthetic::mouse >( hz, 100 * ms, hyde::synthetic::BUTTON, hyde::synthetic::mouse::LEFT, left_button );
+        on_events< hyde::synthetic::mouse >( hz, ms / 2, hyde::synthetic::BUTTON, hyde::synthetic::mouse::LEFT, left_button );
+    }
+
+    changes();
+
+    std::cout << "test.gestures: ok" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+// checks hyde::recorder and hyde::replayer: a recorded session replays into the same samples,
+// the recorder leaves listeners installed after it alone, and seeking lands on the same state
+// than replaying linearly up to the same moment.
+// runs under a hid::virtual_clock, so timestamps are exact.
+// usage: test.session (exits 0 on success, asserts otherwise)
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "../hyde.hpp"
+
+const char *const path = "test.session.rec";
+
+struct counter : public hyde::hid::listener
+{
+    size_t sets;
+    hyde::hid::listener *previous;
+
+    counter() : sets( 0 ), previous( 0 )
+    {}
+
+    void on_set( const void *control, const hyde::hid::tick &t, const float *values, size_t dims )
+    {
+        if( previous )
+            previous->on_set( control, t, values, dims );
+
+        ++sets;
+    }
+};
+
+// a button tapped and a coordinate moving, with uneven spacing
+void play( hyde::hid::virtual_clock &clock, hyde::button &button, hyde::coordinate &coord, int from, int to )
+{
+    for( int step = from; step < to; ++step )
+    {
+        clock.advance_ticks( 1000000 + ( step % 7 ) * 333333 );
+
+        button.set_at( clock.now(), step % 5 < 2 ? 0.5f : 0.f );
+        coord.set_at( clock.now(), float( step % 11 ), step * 0.1f );
+    }
+}
+
+// same values, same spacing: replayed samples are only shifted in time.
+// newest half only, as the oldest ones predate the recording
+template< typename HISTORY >
+void compare( const HISTORY &a, const HISTORY &b )
+{
+    for( size_t i = 0; i < a.size() / 2; ++i )
+    {
+        assert( hyde::same_sample( a.at(i), b.at(i) ) );
+        assert( a.at(i).t - a.at(0).t == b.at(i).t - b.at(0).t );
+    }
+}
+
+void round_trip()
+{
+    hyde::hid::virtual_clock clock( 1000000000 );
+    hyde::hid::clock_scope scope( &clock );
+
+    hyde::button button, recorded_button;
+    hyde::coordinate coord, recorded_coord;
+
+    size_t recorded;
+
+    {
+        hyde::recorder rec( path );
+        assert( rec.is_open() );
+
+        rec.add( button );
+        rec.add( coord );
+        rec.start();
+
+        play( clock, button, coord, 0, 100 );
+
+        // a listener installed while recording survives the recorder's stop()
+        counter later;
+        later.previous = hyde::global_timer.listen( &later );
+
+        play( clock, button, coord, 100, 200 );
+
+        rec.stop();
+        assert( hyde::global_timer.listening() == &later );
+
+        // what the log saw
+        recorded_button = button;
+        recorded_coord = coord;
+        recorded = rec.size();
+        assert( recorded == 2 * 200 );
+
+        play( clock, button, coord, 200, 210 );
+        assert( later.sets == 2 * 110 );
+        assert( rec.size() == recorded );
+
+        // restoring its own previous puts the recorder back on top: now it can unlink
+        hyde::global_timer.listen( later.previous );
+        rec.stop();
+        assert( hyde::global_timer.listening() == 0 );
+    }
+
+    hyde::hid::virtual_clock replay_clock( 5000000000LL );
+    hyde::hid::clock_scope replay_scope( &replay_clock );
+
+    hyde::button replayed_button;
+    hyde::coordinate replayed_coord;
+
+    hyde::replayer replay( path, hyde::replayer::fast );
+    assert( replay.is_open() );
+
+    replay.set_clock( &replay_clock );
+    replay.add( replayed_button );
+    replay.add( replayed_coord );
+
+    while( replay.update() )
+        ;
+
+    assert( replay.size() == recorded );
+
+    compare( recorded_button, replayed_button );
+    compare( recorded_coord, replayed_coord );
+}
+
+// same values and same age (relative to each 'now') for every sample newer than 'window' seconds
+template< typename HISTORY >
+void compare_recent( const HISTORY &a, hyde::hid::tick a_now, const HISTORY &b, hyde::hid::tick b_now, double window )
+{
+    size_t checked = 0;
+
+    for( size_t i = 0; i < a.size() && a_now - a.at(i).t <= hyde::hid::dt::to_ticks( window ); ++i, ++checked )
+    {
+        assert( hyde::same_sample( a.at(i), b.at(i) ) );
+        assert( a_now - a.at(i).t == b_now - b.at(i).t );
+    }
+
+    assert( checked > 1 );
+
+    assert( a.idle() == b.idle() && a.trigger() == b.trigger() && a.hold() == b.hold() );
+    assert( a.release() == b.release() && a.click() == b.click() && a.dclick() == b.dclick() );
+}
+
+void seek_vs_linear()
+{
+    // 10 seconds of taps and motion
+    {
+        hyde::hid::virtual_clock clock( 1000000000 );
+        hyde::hid::clock_scope scope( &clock );
+
+        hyde::button button;
+        hyde::coordinate coord;
+
+        hyde::recorder rec( path );
+        rec.add( button );
+        rec.add( coord );
+        rec.start();
+
+        play( clock, button, coord, 0, 100 );
+
+        for( int step = 0; clock.now() < 11000000000LL; ++step )
+        {
+            clock.advance_ticks( 40000000 + ( step % 13 ) * 7000000 );
+            button.set_at( clock.now(), step % 3 ? 0.5f : 0.f );
+            coord.set_at( clock.now(), float( step % 17 ), -0.5f * step );
+        }
+
+        rec.stop();
+    }
+
+    const double at = 6.3, warmup = 2.0;
+
+    // linear: realtime replay, with the virtual clock moved straight to 'at'
+    hyde::hid::virtual_clock linear_clock( 3000000000LL );
+    hyde::button linear_button;
+    hyde::coordinate linear_coord;
+    hyde::replayer linear( path, hyde::replayer::realtime );
+    {
+        hyde::hid::clock_scope scope( &linear_clock );
+
+        linear.add( linear_button );
+        linear.add( linear_coord );
+
+        assert( linear.update() );
+        linear_clock.advance( at );
+        assert( linear.update() );
+    }
+
+    // seek: from the nearest checkpoint, plus 'warmup' seconds of records
+    hyde::hid::virtual_clock seek_clock( 7000000000LL );
+    hyde::button seek_button;
+    hyde::coordinate seek_coord;
+    hyde::replayer seeker( path, hyde::replayer::realtime, 1.0 );
+    {
+        hyde::hid::clock_scope scope( &seek_clock );
+
+        seeker.add( seek_button );
+        seeker.add( seek_coord );
+
+        assert( seeker.duration() > at );
+        assert( seeker.seek( at, warmup ) );
+        assert( seeker.size() < linear.size() );
+    }
+
+    compare_recent( linear_button, linear_clock.now(), seek_button, seek_clock.now(), warmup );
+    compare_recent( linear_coord, linear_clock.now(), seek_coord, seek_clock.now(), warmup );
+
+    // both go on from there in step
+    {
+        hyde::hid::clock_scope scope( &linear_clock );
+        linear_clock.advance( 1.5 );
+        assert( linear.update() );
+    }
+    {
+        hyde::hid::clock_scope scope( &seek_clock );
+        seek_clock.advance( 1.5 );
+        assert( seeker.update() );
+    }
+
+    compare_recent( linear_button, linear_clock.now(), seek_button, seek_clock.now(), warmup );
+    compare_recent( linear_coord, linear_clock.now(), seek_coord, seek_clock.now(), warmup );
+}
+
+int main()
+{
+    round_trip();
+    seek_vs_linear();
+
+    std::remove( path );
+
+    std::cout << "test.session: ok" << std::endl;
+    return EXIT_SUCCESS;
+}
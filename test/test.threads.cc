@@ -0,0 +1,104 @@
+// checks that hyde::global_timer frames and listeners are per thread: a frame or a recorder
+// on one thread does not freeze, track or log what another thread updates meanwhile.
+// build with -fsanitize=thread to check for races as well.
+// usage: test.threads (exits 0 on success, asserts otherwise)
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../hyde.hpp"
+
+struct counter : public hyde::hid::listener
+{
+    size_t sets;
+
+    counter() : sets( 0 )
+    {}
+
+    void on_set( const void *, const hyde::hid::tick &, const float *, size_t )
+    {
+        ++sets;
+    }
+};
+
+// polls a synthetic keyboard on its own clock, within frames that track changes
+void tooling( std::atomic< bool > &frozen, std::atomic< bool > &done )
+{
+    hyde::hid::virtual_clock clock( 5000000000LL );
+    hyde::hid::clock_scope scope( &clock );
+
+    // wait for the main thread to be within a frame
+    while( !frozen.load() )
+        std::this_thread::yield();
+
+    hyde::synthetic::keyboard keyboard;
+    keyboard.add_generator( hyde::synthetic::random_generator( hyde::synthetic::KEY, 1000, 256, 0, 1 ) );
+
+    std::vector< const void * > changes;
+
+    for( int poll = 0; poll < 100; ++poll )
+    {
+        clock.advance( 0.01 );
+
+        changes.clear();
+        {
+            hyde::hid::frame frame( hyde::global_timer, &changes );
+            assert( hyde::global_timer.now() == clock.now() );
+
+            keyboard.update();
+        }
+
+        assert( !changes.empty() );
+        assert( keyboard.is_ready.newest().t == clock.now() );
+    }
+
+    done = true;
+}
+
+int main()
+{
+    hyde::hid::virtual_clock clock( 1000000000 );
+    hyde::hid::clock_scope scope( &clock );
+
+    counter sets;
+    hyde::hid::listener *previous = hyde::global_timer.listen( &sets );
+
+    std::vector< const void * > changes;
+    std::atomic< bool > frozen( false ), done( false );
+
+    std::thread other( tooling, std::ref( frozen ), std::ref( done ) );
+
+    hyde::button button;
+
+    {
+        hyde::hid::frame frame( hyde::global_timer, &changes );
+        hyde::hid::tick now = hyde::global_timer.now();
+
+        frozen = true;
+
+        // the other thread polls 100 times meanwhile: this frame stays as it was
+        while( !done.load() )
+        {
+            clock.advance_ticks( 1000 );
+            assert( hyde::global_timer.now() == now );
+            std::this_thread::yield();
+        }
+
+        button.set( 0.5f );
+        assert( button.newest().t == now );
+    }
+
+    other.join();
+
+    // only this thread's set() was logged and tracked
+    assert( sets.sets == 1 );
+    assert( changes.size() == 1 && changes[0] == &button );
+    assert( hyde::global_timer.listen( previous ) == &sets );
+
+    std::cout << "test.threads: ok" << std::endl;
+    return EXIT_SUCCESS;
+}